@@ -0,0 +1,120 @@
+#include "app.h"
+
+void app_init(App *app, int view_width, int view_height){
+    float w = (float)view_width, h = (float)view_height;
+    app->state = MENU;      // The game starts on the main menu screen
+    app_set_target_fps(app, 60);   // Default FPS set to 60
+    app->pacing_mode = PACING_HYBRID;
+    app->sound_volume = APP_SOUND_STEPS;
+    app->play_button = (SimRect){w/2 - 100, h/2 - 50, 200, 60};
+    app->settings_button = (SimRect){w/2 - 100, h/2 + 50, 200, 60};
+    app->back_button = (SimRect){50, 50, 100, 40};
+    for (int row = 0; row < APP_SETTING_COUNT; row++) {
+        app->setting_left[row] = (SimRect){w/2 - 110, h/2 + 5 + 50 * row, 30, 30};
+        app->setting_right[row] = (SimRect){w/2 + 80, h/2 + 5 + 50 * row, 30, 30};
+    }
+}
+
+void app_set_target_fps(App *app, int target_fps){
+    app->target_fps = pacing_valid_target(target_fps);
+    app->fps_choice_count = 0;
+    int listed = 0;
+    for (int i = 0; i < PACING_TARGET_COUNT; i++) {
+        if (!listed && app->target_fps <= pacing_targets[i]) {
+            listed = 1;
+            if (app->target_fps < pacing_targets[i]) app->fps_choices[app->fps_choice_count++] = app->target_fps;
+        }
+        app->fps_choices[app->fps_choice_count++] = pacing_targets[i];
+    }
+    if (!listed) app->fps_choices[app->fps_choice_count++] = app->target_fps;
+}
+
+int app_setting_count(const App *app, AppSetting setting){
+    switch (setting) {
+        case APP_SETTING_FPS: return app->fps_choice_count;
+        case APP_SETTING_PACING: return PACING_MODE_COUNT;
+        case APP_SETTING_SOUND: return APP_SOUND_STEPS + 1;
+        default: return 0;
+    }
+}
+
+int app_setting_get(const App *app, AppSetting setting){
+    switch (setting) {
+        case APP_SETTING_FPS: {
+            int index = 0;
+            while (index < app->fps_choice_count - 1 && app->fps_choices[index] != app->target_fps) index++;
+            return index;
+        }
+        case APP_SETTING_PACING: return app->pacing_mode;
+        case APP_SETTING_SOUND: return app->sound_volume;
+        default: return 0;
+    }
+}
+
+// Stores the new value and returns the events it causes
+static unsigned int setting_set(App *app, AppSetting setting, int index){
+    switch (setting) {
+        case APP_SETTING_FPS: app->target_fps = app->fps_choices[index]; return APP_EVENT_PACING_CHANGED;
+        case APP_SETTING_PACING: app->pacing_mode = index; return APP_EVENT_PACING_CHANGED;
+        case APP_SETTING_SOUND: app->sound_volume = index; return APP_EVENT_SOUND_CHANGED;
+        default: return 0;
+    }
+}
+
+// Same test as raylib's CheckCollisionPointRec
+int app_point_in_rect(SimRect rect, float x, float y){
+    return x >= rect.x && x < rect.x + rect.width && y >= rect.y && y < rect.y + rect.height;
+}
+
+unsigned int app_click(App *app, float x, float y){
+    unsigned int events = 0;
+    switch (app->state) {
+        case MENU:
+            // Play button clicked -> go to GAME
+            if (app_point_in_rect(app->play_button, x, y)) {
+                events |= APP_EVENT_BUTTON_SOUND | APP_EVENT_MUSIC_GAME;
+                app->state = GAME;
+            }
+            // Settings button clicked -> go to SETTINGS
+            if (app_point_in_rect(app->settings_button, x, y)) {
+                events |= APP_EVENT_BUTTON_SOUND;
+                app->state = SETTINGS;
+            }
+            break;
+
+        case SETTINGS:
+            // Back button clicked -> return to MENU
+            if (app_point_in_rect(app->back_button, x, y)) {
+                events |= APP_EVENT_BUTTON_SOUND;
+                app->state = MENU;
+            }
+            // Row arrows -> previous/next value (FPS 30 ... 240 and a configured one, Hybrid / VSync / Uncapped,
+            // sound 0% ... 100%),
+            // stopping at either end
+            for (int row = 0; row < APP_SETTING_COUNT; row++) {
+                int left = app_point_in_rect(app->setting_left[row], x, y);
+                if (!left && !app_point_in_rect(app->setting_right[row], x, y)) continue;
+                int index = app_setting_get(app, (AppSetting)row) + (left ? -1 : 1);
+                events |= APP_EVENT_BUTTON_SOUND;
+                if (index >= 0 && index < app_setting_count(app, (AppSetting)row)) events |= setting_set(app, (AppSetting)row, index);
+            }
+            break;
+
+        case GAME:
+            break;
+    }
+    return events;
+}
+
+/**
+ * STATE SHORTCUT
+ * --------------
+ * Pressing ESC during gameplay switches back to MENU and the menu music.
+ * The caller uses IsKeyPressed so this triggers once per key press, not every
+ * frame the key is held.
+ */
+unsigned int app_escape(App *app){
+    if (app->state != GAME) return 0;
+    app->state = MENU;
+    return APP_EVENT_MUSIC_MENU;
+}
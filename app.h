@@ -0,0 +1,74 @@
+#ifndef APP_H
+#define APP_H
+
+#include "sim.h"
+#include "pacing.h"
+
+// ----------------------------
+// SCREENS AND BUTTONS
+// ----------------------------
+// Menu and settings logic without raylib. The window code turns mouse clicks and
+// ESC into app_click()/app_escape() and acts on the events they return (sounds,
+// music, frame rate). Replays call the same functions, so a recorded session goes
+// through exactly the same screens.
+
+// Enum to define game states (screens)
+typedef enum {
+    MENU,       // Main menu (shows Play + Settings options)
+    GAME,       // Gameplay screen (car driving in the world)
+    SETTINGS    // Settings screen (frame rate, pacing and sound volume, go back)
+} GameState;
+
+// Side effects the window code carries out after a click or ESC
+#define APP_EVENT_BUTTON_SOUND   1u   // Play the button sound
+#define APP_EVENT_MUSIC_GAME     2u   // Switch from the menu music to the in-game track
+#define APP_EVENT_MUSIC_MENU     4u   // Switch back to the menu music
+#define APP_EVENT_PACING_CHANGED 8u   // Apply (and save) pacing_mode / target_fps
+#define APP_EVENT_SOUND_CHANGED  16u  // Apply (and save) sound_volume
+
+#define APP_SOUND_STEPS 10   // Sound volume runs from 0 to APP_SOUND_STEPS tenths
+
+// Rows of the settings screen, each a value stepped with a left and a right arrow
+typedef enum {
+    APP_SETTING_FPS,      // Index into App.fps_choices
+    APP_SETTING_PACING,   // PacingMode
+    APP_SETTING_SOUND,    // App.sound_volume
+    APP_SETTING_COUNT
+} AppSetting;
+
+typedef struct {
+    GameState state;
+    int target_fps;            // Used by PACING_HYBRID; set with app_set_target_fps()
+    int pacing_mode;           // PacingMode
+    int fps_choices[PACING_TARGET_COUNT + 1];   // The presets, plus a configured target that is none of them
+    int fps_choice_count;
+    int sound_volume;          // Sound effect volume in tenths, 0 .. APP_SOUND_STEPS
+    SimRect play_button;       // "Play" button in menu
+    SimRect settings_button;   // "Settings" button in menu
+    SimRect back_button;       // Back button in settings screen
+    SimRect setting_left[APP_SETTING_COUNT];    // Arrows of each settings row, one row per 50px
+    SimRect setting_right[APP_SETTING_COUNT];
+} App;
+
+// Starts on the menu with hybrid pacing at 60 FPS, full sound volume and the buttons laid out for the given window
+void app_init(App *app, int view_width, int view_height);
+
+// Any target from PACING_MIN_FPS to PACING_MAX_FPS (clamped); one that is not a preset
+// joins the settings row's choices, in order, so the arrows can come back to it
+void app_set_target_fps(App *app, int target_fps);
+
+// Left click at (x, y) in screen pixels; returns APP_EVENT_* bits
+unsigned int app_click(App *app, float x, float y);
+
+// ESC pressed; returns APP_EVENT_* bits
+unsigned int app_escape(App *app);
+
+// Number of values a settings row steps through
+int app_setting_count(const App *app, AppSetting setting);
+
+// Index of the row's current value, in 0 .. app_setting_count() - 1
+int app_setting_get(const App *app, AppSetting setting);
+
+int app_point_in_rect(SimRect rect, float x, float y);
+
+#endif
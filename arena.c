@@ -0,0 +1,46 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+int arena_init(Arena *arena, size_t capacity){
+    memset(arena, 0, sizeof *arena);
+    arena->base = malloc(capacity);
+    if (!arena->base) return -1;
+    arena->capacity = capacity;
+    return 0;
+}
+
+void arena_free(Arena *arena){
+    free(arena->base);
+    memset(arena, 0, sizeof *arena);
+}
+
+/**
+ * BUMP ALLOCATION
+ * ---------------
+ * Every size is rounded up to ARENA_ALIGN and claimed with one fetch-add on
+ * `used`, so threads never wait for each other. A request that runs past the end
+ * fails but still counts, which tells arena_reset() how much the tick really needed.
+ */
+void *arena_alloc(Arena *arena, size_t size){
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t offset = __atomic_fetch_add(&arena->used, size, __ATOMIC_RELAXED);
+    if (offset + size > arena->capacity) {
+        __atomic_fetch_add(&arena->overflows, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    return arena->base + offset;
+}
+
+void arena_reset(Arena *arena){
+    if (arena->used > arena->capacity) {
+        size_t capacity = arena->capacity * 2 > arena->used ? arena->capacity * 2 : arena->used;
+        unsigned char *base = malloc(capacity);
+        if (base) {   // Otherwise keep the old block; callers cope with NULL
+            free(arena->base);
+            arena->base = base;
+            arena->capacity = capacity;
+        }
+    }
+    arena->used = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// ----------------------------
+// FRAME ARENA
+// ----------------------------
+// Scratch memory for one tick: allocating is one atomic add (so jobs on any
+// thread can use it), nothing is freed individually and arena_reset() drops
+// everything at once. Nothing allocated here may be kept past the next reset.
+
+#define ARENA_ALIGN 16
+
+typedef struct {
+    unsigned char *base;
+    size_t capacity;
+    size_t used;               // Bumped atomically; counts failed requests too
+    unsigned long overflows;   // Allocations that did not fit (the arena grows on reset)
+} Arena;
+
+// Reserves `capacity` bytes; 0 on success, -1 if out of memory
+int arena_init(Arena *arena, size_t capacity);
+
+void arena_free(Arena *arena);
+
+// Thread-safe; returns ARENA_ALIGN-aligned memory, or NULL if the arena is full
+void *arena_alloc(Arena *arena, size_t size);
+
+// Forget every allocation; if the last tick ran out of room, grow first. Only
+// call while no job is using the arena.
+void arena_reset(Arena *arena);
+
+#endif
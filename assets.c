@@ -0,0 +1,241 @@
+#define _POSIX_C_SOURCE 200809L
+#include "assets.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define ASSET_ITEMS (ASSET_IMAGE_COUNT + 1)     // Images plus the button sound
+#define CACHE_MAGIC 0x31414352                  // "RCA1"
+#define CACHE_VERSION 1
+#define CACHE_PATH_MAX 256                      // Longest cache file path, terminator included
+
+// How each image is prepared before upload. width/height 0 keeps the decoded size;
+// fit_view resizes to the window, which is the only size it is ever drawn at.
+typedef struct {
+    const char *path;
+    const char *cache_name;
+    int rotate_cw;
+    int fit_view;
+    int width, height;
+} ImageSpec;
+
+static const ImageSpec image_specs[ASSET_IMAGE_COUNT] = {
+    [ASSET_MENU_BACKGROUND] = {"home_page_background.jpg", "menu_background", 0, 1, 0, 0},
+    [ASSET_ARROW_LEFT] = {"left-arrow.png", "arrow_left", 0, 0, 30, 30},      // drawn 30x30
+    [ASSET_ARROW_RIGHT] = {"right-arrow.png", "arrow_right", 0, 0, 30, 30},
+    [ASSET_SOIL] = {"Soil_Tile.png", "soil", 1, 0, 0, 0},                     // 1 texel = 1 world px
+    [ASSET_CAR] = {"Car_1_01.png", "car", 1, 0, 240, 118},                    // 2x the 120px car
+};
+
+static const char *button_sound_path = "coin-collect-retro-8-bit-sound-effect-145251.mp3";
+static const char *menu_music_path = "8-bit-heaven-26287.mp3";
+static const char *game_music_path = "2018-08-01-30015.mp3";
+
+// Everything that decides the cached pixels; any change invalidates the file
+typedef struct {
+    int magic, version;
+    long long source_mtime, source_size;
+    int rotate_cw, width, height;
+    int image_width, image_height, image_format, data_size;
+} CacheHeader;
+
+double assets_clock(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ----------------------------
+// RAW IMAGE CACHE
+// ----------------------------
+/**
+ * CACHE FILES
+ * -----------
+ * .cache/<name>.raw holds a CacheHeader followed by the pixel bytes exactly as
+ * raylib wants them for LoadTextureFromImage(). A file is only trusted if the
+ * source's size and modification time and the transform still match, so editing
+ * an asset or changing how it is prepared rebuilds the entry on the next launch.
+ */
+static CacheHeader expected_header(const ImageSpec *spec, int width, int height, const struct stat *source){
+    CacheHeader header;
+    memset(&header, 0, sizeof header);
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.source_mtime = (long long)source->st_mtime;
+    header.source_size = (long long)source->st_size;
+    header.rotate_cw = spec->rotate_cw;
+    header.width = width;
+    header.height = height;
+    return header;
+}
+
+static int cache_read(const char *cache_path, const CacheHeader *expected, Image *image){
+    FILE *file = fopen(cache_path, "rb");
+    if (!file) return 0;
+    CacheHeader header;
+    int ok = fread(&header, sizeof header, 1, file) == 1 &&
+             header.magic == expected->magic && header.version == expected->version &&
+             header.source_mtime == expected->source_mtime && header.source_size == expected->source_size &&
+             header.rotate_cw == expected->rotate_cw &&
+             header.width == expected->width && header.height == expected->height &&
+             header.data_size == GetPixelDataSize(header.image_width, header.image_height, header.image_format);
+    void *data = ok ? malloc(header.data_size) : NULL;   // raylib frees image data with free()
+    ok = data && fread(data, header.data_size, 1, file) == 1;
+    fclose(file);
+    if (!ok) {
+        free(data);
+        return 0;
+    }
+    *image = (Image){data, header.image_width, header.image_height, 1, header.image_format};
+    return 1;
+}
+
+static void cache_write(const char *cache_path, const CacheHeader *expected, Image image){
+    CacheHeader header = *expected;
+    header.image_width = image.width;
+    header.image_height = image.height;
+    header.image_format = image.format;
+    header.data_size = GetPixelDataSize(image.width, image.height, image.format);
+
+    // Write to a temporary name and rename, so a crash never leaves a torn file
+    char temp_path[CACHE_PATH_MAX + 4];
+    snprintf(temp_path, sizeof temp_path, "%s.tmp", cache_path);
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) return;
+    int ok = fwrite(&header, sizeof header, 1, file) == 1 && fwrite(image.data, header.data_size, 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    if (ok) rename(temp_path, cache_path);
+    else remove(temp_path);
+}
+
+// ----------------------------
+// WORKER
+// ----------------------------
+static Image prepare_image(AssetLoader *assets, const ImageSpec *spec){
+    int width = spec->fit_view ? assets->view_width : spec->width;
+    int height = spec->fit_view ? assets->view_height : spec->height;
+
+    struct stat source;
+    char cache_path[CACHE_PATH_MAX];
+    int length = snprintf(cache_path, sizeof cache_path, "%s/%s.raw", ASSET_CACHE_DIR, spec->cache_name);
+    int can_cache = assets->use_cache && length < (int)sizeof cache_path && stat(spec->path, &source) == 0;
+    CacheHeader header;
+    Image image;
+    if (can_cache) {
+        header = expected_header(spec, width, height, &source);
+        if (cache_read(cache_path, &header, &image)) {
+            pthread_mutex_lock(&assets->lock);
+            assets->cache_hits++;
+            pthread_mutex_unlock(&assets->lock);
+            return image;
+        }
+    }
+
+    image = LoadImage(spec->path);
+    if (spec->rotate_cw) ImageRotateCW(&image);   // Rotate image to proper orientation
+    if (width > 0 && height > 0 && (image.width != width || image.height != height)) ImageResize(&image, width, height);
+    if (can_cache && image.data) cache_write(cache_path, &header, image);
+    return image;
+}
+
+static void *asset_worker(void *arg){
+    AssetLoader *assets = arg;
+    if (assets->use_cache) mkdir(ASSET_CACHE_DIR, 0755);
+
+    for (int i = 0; i < ASSET_IMAGE_COUNT; i++) {
+        Image image = prepare_image(assets, &image_specs[i]);
+        pthread_mutex_lock(&assets->lock);
+        assets->images[i] = image;
+        assets->image_ready[i] = 1;
+        assets->decoded++;
+        pthread_mutex_unlock(&assets->lock);
+    }
+
+    // Decoding the MP3 to PCM is the slow part of LoadSound(); the device part is done later
+    Wave wave = LoadWave(button_sound_path);
+    pthread_mutex_lock(&assets->lock);
+    assets->button_wave = wave;
+    assets->wave_ready = 1;
+    assets->decoded++;
+    pthread_mutex_unlock(&assets->lock);
+    return NULL;
+}
+
+// ----------------------------
+// MAIN THREAD
+// ----------------------------
+void assets_start(AssetLoader *assets, int view_width, int view_height, int threaded, int use_cache){
+    memset(assets, 0, sizeof *assets);
+    pthread_mutex_init(&assets->lock, NULL);
+    assets->view_width = view_width;
+    assets->view_height = view_height;
+    assets->use_cache = use_cache;
+    assets->threaded = threaded && pthread_create(&assets->worker, NULL, asset_worker, assets) == 0;
+    if (!assets->threaded) asset_worker(assets);
+}
+
+int assets_update(AssetLoader *assets){
+    if (assets->finished) return 1;
+
+    // Take ownership of finished items under the lock, upload them outside it
+    Image ready[ASSET_IMAGE_COUNT];
+    int ready_ids[ASSET_IMAGE_COUNT];
+    int ready_count = 0, wave_ready = 0;
+    Wave wave;
+    pthread_mutex_lock(&assets->lock);
+    for (int i = 0; i < ASSET_IMAGE_COUNT; i++) {
+        if (assets->image_ready[i] == 1) {
+            assets->image_ready[i] = 2;   // Uploaded (or being uploaded) by the main thread
+            ready[ready_count] = assets->images[i];
+            ready_ids[ready_count++] = i;
+        }
+    }
+    if (assets->wave_ready == 1) {
+        assets->wave_ready = 2;
+        wave = assets->button_wave;
+        wave_ready = 1;
+    }
+    pthread_mutex_unlock(&assets->lock);
+
+    for (int i = 0; i < ready_count; i++) {
+        assets->textures[ready_ids[i]] = LoadTextureFromImage(ready[i]);
+        UnloadImage(ready[i]);   // The GPU copy is all the game needs
+        assets->uploaded++;
+    }
+    if (wave_ready) {
+        assets->button_sound = LoadSoundFromWave(wave);   // Keeps the PCM, no decoding at play time
+        UnloadWave(wave);
+        assets->uploaded++;
+    }
+
+    if (assets->uploaded < ASSET_ITEMS) return 0;
+    if (assets->threaded) pthread_join(assets->worker, NULL);
+    assets->menu_music = LoadMusicStream(menu_music_path);   // Streams from disk, opening is cheap
+    assets->game_music = LoadMusicStream(game_music_path);
+    assets->finished = 1;
+    return 1;
+}
+
+float assets_progress(AssetLoader *assets){
+    pthread_mutex_lock(&assets->lock);
+    int decoded = assets->decoded;
+    pthread_mutex_unlock(&assets->lock);
+    return (decoded + assets->uploaded) / (2.0f * ASSET_ITEMS);
+}
+
+void assets_unload(AssetLoader *assets){
+    if (assets->threaded && !assets->finished) pthread_join(assets->worker, NULL);
+    for (int i = 0; i < ASSET_IMAGE_COUNT; i++) {
+        if (assets->image_ready[i] == 1) UnloadImage(assets->images[i]);
+        if (assets->textures[i].id != 0) UnloadTexture(assets->textures[i]);
+    }
+    if (assets->wave_ready == 1) UnloadWave(assets->button_wave);
+    if (assets->wave_ready == 2) UnloadSound(assets->button_sound);
+    if (assets->finished) {
+        UnloadMusicStream(assets->menu_music);
+        UnloadMusicStream(assets->game_music);
+    }
+    pthread_mutex_destroy(&assets->lock);
+}
@@ -0,0 +1,68 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <raylib.h>
+#include <pthread.h>
+
+// ----------------------------
+// ASSET LOADER
+// ----------------------------
+// Decodes images and sound effects on a worker thread while the main thread keeps
+// drawing a loading screen. Only the GPU uploads (textures) and the audio-device
+// calls happen on the main thread. Decoded, rotated and resized images are cached
+// in .cache/ as raw pixels, so later launches skip PNG/JPG decoding entirely.
+
+#define ASSET_CACHE_DIR ".cache"
+
+typedef enum {
+    ASSET_MENU_BACKGROUND,
+    ASSET_ARROW_LEFT,
+    ASSET_ARROW_RIGHT,
+    ASSET_SOIL,
+    ASSET_CAR,
+    ASSET_IMAGE_COUNT
+} AssetImageId;
+
+typedef struct {
+    // Results, valid once assets_update() returned 1
+    Texture2D textures[ASSET_IMAGE_COUNT];
+    Sound button_sound;        // Decoded to PCM once, on the worker
+    Music menu_music;
+    Music game_music;          // Streamed while driving
+
+    // Worker → main thread hand-off (guarded by lock)
+    pthread_t worker;
+    pthread_mutex_t lock;
+    Image images[ASSET_IMAGE_COUNT];
+    int image_ready[ASSET_IMAGE_COUNT];
+    Wave button_wave;
+    int wave_ready;
+    int decoded;               // Items the worker has finished
+    int cache_hits;            // Images that came from .cache/
+
+    // Main thread only
+    int uploaded;              // Items turned into textures/sounds
+    int threaded;              // 0 when loading inline (--sync-assets)
+    int use_cache;             // 0 with --no-asset-cache
+    int view_width, view_height;
+    int finished;
+} AssetLoader;
+
+// Monotonic clock in seconds; works before InitWindow() (for time-to-first-frame)
+double assets_clock(void);
+
+// Starts decoding. With threaded = 0 everything is decoded before this returns,
+// which is how the game used to load. Needs InitWindow() and InitAudioDevice().
+void assets_start(AssetLoader *assets, int view_width, int view_height, int threaded, int use_cache);
+
+// Uploads whatever the worker finished since the last call; returns 1 once
+// every asset is ready to use
+int assets_update(AssetLoader *assets);
+
+// Fraction of the work done, 0..1, for the loading bar
+float assets_progress(AssetLoader *assets);
+
+// Waits for the worker and frees everything, loaded or not
+void assets_unload(AssetLoader *assets);
+
+#endif
@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 199309L
+#include "audio.h"
+#include <string.h>
+#include <time.h>
+
+static void run_command(AudioSystem *audio, AudioCommand command){
+    switch (command.type) {
+        case AUDIO_PLAY_SOUND:
+            PlaySound(audio->sounds[command.target]);
+            break;
+        case AUDIO_PLAY_MUSIC:
+            PlayMusicStream(audio->tracks[command.target]);
+            audio->playing[command.target] = 1;
+            break;
+        case AUDIO_STOP_MUSIC:
+            StopMusicStream(audio->tracks[command.target]);
+            audio->playing[command.target] = 0;
+            break;
+        case AUDIO_SET_SOUND_VOLUME:
+            SetSoundVolume(audio->sounds[command.target], command.value);
+            break;
+        case AUDIO_SET_MUSIC_VOLUME:
+            SetMusicVolume(audio->tracks[command.target], command.value);
+            break;
+    }
+    audio->processed++;
+}
+
+/**
+ * STREAMING
+ * ---------
+ * A music stream plays from a ring of PCM buffers that UpdateMusicStream refills
+ * from the MP3 as they drain. On the game thread a long frame (loading, a window
+ * drag, a debugger) let the buffers run dry and the music stutter. Here they are
+ * topped up every AUDIO_UPDATE_NS no matter what the game is doing, and only for
+ * tracks that are actually playing.
+ */
+static void *audio_thread(void *arg){
+    AudioSystem *audio = arg;
+    struct timespec pause = {0, AUDIO_UPDATE_NS};
+    while (__atomic_load_n(&audio->running, __ATOMIC_ACQUIRE)) {
+        AudioCommand command;
+        while (audio_queue_pop(&audio->queue, &command)) run_command(audio, command);
+        for (int i = 0; i < AUDIO_TRACK_COUNT; i++) {
+            if (audio->playing[i]) UpdateMusicStream(audio->tracks[i]);
+        }
+        nanosleep(&pause, NULL);
+    }
+    for (int i = 0; i < AUDIO_TRACK_COUNT; i++) {
+        if (audio->playing[i]) StopMusicStream(audio->tracks[i]);
+    }
+    return NULL;
+}
+
+int audio_start(AudioSystem *audio, const Sound *sounds, const Music *tracks){
+    memset(audio, 0, sizeof *audio);
+    memcpy(audio->sounds, sounds, sizeof audio->sounds);
+    memcpy(audio->tracks, tracks, sizeof audio->tracks);
+    audio_queue_init(&audio->queue);
+    audio->running = 1;
+    if (pthread_create(&audio->thread, NULL, audio_thread, audio) != 0) {
+        audio->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void audio_stop(AudioSystem *audio){
+    if (!audio->running) return;
+    __atomic_store_n(&audio->running, 0, __ATOMIC_RELEASE);
+    pthread_join(audio->thread, NULL);
+}
+
+static void push(AudioSystem *audio, int type, int target, float value){
+    if (!audio_queue_push(&audio->queue, (AudioCommand){type, target, value})) audio->dropped++;
+}
+
+void audio_play_sound(AudioSystem *audio, AudioSoundId sound){
+    push(audio, AUDIO_PLAY_SOUND, sound, 0);
+}
+
+void audio_play_music(AudioSystem *audio, AudioTrackId track){
+    push(audio, AUDIO_PLAY_MUSIC, track, 0);
+}
+
+void audio_stop_music(AudioSystem *audio, AudioTrackId track){
+    push(audio, AUDIO_STOP_MUSIC, track, 0);
+}
+
+void audio_set_sound_volume(AudioSystem *audio, AudioSoundId sound, float volume){
+    push(audio, AUDIO_SET_SOUND_VOLUME, sound, volume);
+}
+
+void audio_set_music_volume(AudioSystem *audio, AudioTrackId track, float volume){
+    push(audio, AUDIO_SET_MUSIC_VOLUME, track, volume);
+}
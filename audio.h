@@ -0,0 +1,53 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <raylib.h>
+#include <pthread.h>
+#include "audio_queue.h"
+
+// ----------------------------
+// AUDIO THREAD
+// ----------------------------
+// Owns every sound and music stream once started: it plays the effects, starts and
+// stops the tracks and keeps the playing tracks' buffers filled, every few
+// milliseconds, whatever the game loop is doing. The game thread only pushes
+// commands (audio_play_sound, audio_play_music, ...), which never block.
+
+#define AUDIO_UPDATE_NS 4000000L   // How often the thread wakes up to refill music buffers
+
+typedef enum {
+    AUDIO_SFX_BUTTON,   // Coin collect, decoded to PCM at load time
+    AUDIO_SOUND_COUNT
+} AudioSoundId;
+
+typedef enum {
+    AUDIO_TRACK_MENU,   // 8-bit heaven, loops on the menu and settings screens
+    AUDIO_TRACK_GAME,   // Played while driving
+    AUDIO_TRACK_COUNT
+} AudioTrackId;
+
+typedef struct {
+    Sound sounds[AUDIO_SOUND_COUNT];
+    Music tracks[AUDIO_TRACK_COUNT];
+    int playing[AUDIO_TRACK_COUNT];   // Audio thread only
+    AudioQueue queue;
+    pthread_t thread;
+    int running;                      // Cleared (atomically) to stop the thread
+    unsigned long dropped;            // Commands lost to a full queue (game thread)
+    unsigned long processed;          // Commands handled (audio thread, read after stop)
+} AudioSystem;
+
+// Takes ownership of the loaded sounds and tracks and starts the thread; 0 on success
+int audio_start(AudioSystem *audio, const Sound *sounds, const Music *tracks);
+
+// Stops the thread; the sounds and tracks can be unloaded afterwards
+void audio_stop(AudioSystem *audio);
+
+// Game thread: queue a command
+void audio_play_sound(AudioSystem *audio, AudioSoundId sound);
+void audio_play_music(AudioSystem *audio, AudioTrackId track);
+void audio_stop_music(AudioSystem *audio, AudioTrackId track);
+void audio_set_sound_volume(AudioSystem *audio, AudioSoundId sound, float volume);
+void audio_set_music_volume(AudioSystem *audio, AudioTrackId track, float volume);
+
+#endif
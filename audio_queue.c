@@ -0,0 +1,33 @@
+#include "audio_queue.h"
+#include <string.h>
+
+void audio_queue_init(AudioQueue *queue){
+    memset(queue, 0, sizeof *queue);
+}
+
+/**
+ * ORDERING
+ * --------
+ * The producer writes the command, then publishes it by storing the new tail with
+ * release order; the consumer loads the tail with acquire order before reading the
+ * command, so it always sees the finished write. The same pairing on `head` tells
+ * the producer when a slot has been read and may be reused. The indices run freely
+ * and are masked on use, so tail - head is the fill level even after wrapping.
+ */
+int audio_queue_push(AudioQueue *queue, AudioCommand command){
+    unsigned int tail = queue->tail;   // Only this thread writes it
+    unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (tail - head == AUDIO_QUEUE_CAPACITY) return 0;
+    queue->commands[tail & (AUDIO_QUEUE_CAPACITY - 1)] = command;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int audio_queue_pop(AudioQueue *queue, AudioCommand *command){
+    unsigned int head = queue->head;   // Only this thread writes it
+    unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return 0;
+    *command = queue->commands[head & (AUDIO_QUEUE_CAPACITY - 1)];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
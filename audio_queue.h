@@ -0,0 +1,42 @@
+#ifndef AUDIO_QUEUE_H
+#define AUDIO_QUEUE_H
+
+// ----------------------------
+// AUDIO COMMAND QUEUE
+// ----------------------------
+// Single-producer, single-consumer ring buffer: the game thread pushes commands,
+// the audio thread pops them. Neither side ever blocks or takes a lock; each index
+// is written by one thread only and published with release/acquire ordering.
+
+#define AUDIO_QUEUE_CAPACITY 256   // Power of two
+
+typedef enum {
+    AUDIO_PLAY_SOUND,        // target = AudioSoundId
+    AUDIO_PLAY_MUSIC,        // target = AudioTrackId, restarts from the beginning
+    AUDIO_STOP_MUSIC,        // target = AudioTrackId
+    AUDIO_SET_SOUND_VOLUME,  // target = AudioSoundId, value = 0..1
+    AUDIO_SET_MUSIC_VOLUME   // target = AudioTrackId, value = 0..1
+} AudioCommandType;
+
+typedef struct {
+    int type;      // AudioCommandType
+    int target;
+    float value;
+} AudioCommand;
+
+typedef struct {
+    AudioCommand commands[AUDIO_QUEUE_CAPACITY];
+    unsigned int head;        // Next slot to read, written by the consumer
+    char pad[60];             // Keep the two indices on separate cache lines
+    unsigned int tail;        // Next slot to write, written by the producer
+} AudioQueue;
+
+void audio_queue_init(AudioQueue *queue);
+
+// Producer side; returns 0 if the queue is full (the command is dropped)
+int audio_queue_push(AudioQueue *queue, AudioCommand command);
+
+// Consumer side; returns 0 if the queue is empty
+int audio_queue_pop(AudioQueue *queue, AudioCommand *command);
+
+#endif
@@ -0,0 +1,1090 @@
+#define _POSIX_C_SOURCE 200112L
+#include "headless.h"
+#include "sim.h"
+#include "vehicles.h"
+#include "collision.h"
+#include "profiler.h"
+#include "replay.h"
+#include "world.h"
+#include "pacing.h"
+#include "audio_queue.h"
+#include "jobs.h"
+#include "arena.h"
+#include "netplay.h"
+#include "ghost.h"
+#include "lap.h"
+#include <pthread.h>
+#include <sched.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// ----------------------------
+// BENCHMARK ENTRY POINT
+// ----------------------------
+// Built by `make bench` without raylib, so it runs on machines with no GPU or
+// audio device. Usage: ./raceee_bench [all|sim|vehicles|collision|profiler|world|pacing|audio|jobs|net|ghosts|replay] [options]
+//   sim        --ticks N --seed N         scripted game session (see headless.c),
+//              --record FILE              also saved as a replay
+//   vehicles   --vehicles N --frames N    SoA traffic update vs. a scalar baseline
+//   collision  --bodies N --brute-max N   spatial hash vs. brute force, 10k–100k bodies
+//   profiler   --frames N                 cost of the per-frame phase timers
+//   world      --frames N --chunk-cache-mb N  chunk streaming at top speed, with and without prefetch
+//   pacing     --frames N                 hybrid sleep+spin pacing vs. sleeping alone
+//   audio      --commands N               audio command queue, producer and consumer threads
+//   jobs       --max-threads N            job system scaling from 1 to N threads (default: cores)
+//   net        --clients N --seconds N    loopback multiplayer, clean and with
+//              --net-lag MS --net-loss PCT  lag and loss (default 100 ms, 5%)
+//   ghosts     --minutes N                ghost trajectory size, accuracy, seeking and 1/10/100-ghost frames
+//   replay     --replay FILE              fast-forward a recording and check its end state
+// Every suite also takes --threads N for the job system (default 1, 0 = one per core).
+
+#define FRAME_BUDGET_NS 16666667LL   // One frame at 60 FPS
+#define TICKS_PER_FRAME (SIM_TICK_RATE / 60)
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long arg_long(int argc, char **argv, const char *name, long fallback){
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], name) == 0) return atol(argv[i + 1]);
+    }
+    return fallback;
+}
+
+static int compare_ll(const void *a, const void *b){
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// ----------------------------
+// VEHICLES
+// ----------------------------
+// The single-car code as it was before the store existed (one struct per car,
+// if/else and libm trig), run over the same number of cars for comparison.
+typedef struct {
+    float x, y, speed, rotation;
+    int direction;
+    float throttle, steer;
+} ScalarCar;
+
+static void scalar_update(ScalarCar *cars, int count, const VehicleStore *tuning, float dt){
+    for (int i = 0; i < count; i++) {
+        ScalarCar *car = &cars[i];
+        if (car->throttle > 0) {
+            car->direction = -1;
+            car->speed += tuning->speedup * dt;
+            if (car->speed > tuning->max_speed) car->speed = tuning->max_speed;
+        }
+        else if (car->throttle < 0) {
+            car->direction = 1;
+            car->speed -= tuning->speedup * dt;
+            if (car->speed < -tuning->max_speed) car->speed = -tuning->max_speed;
+        }
+        else {
+            car->speed += tuning->slowdown * dt * car->direction;
+            if (car->direction == -1 && car->speed < 0) car->speed = 0;
+            else if (car->direction == 1 && car->speed > 0) car->speed = 0;
+        }
+        car->rotation += car->steer * ROTATION_SPEED * dt;
+        if (car->rotation >= 360) car->rotation -= 360;
+        if (car->rotation < 0) car->rotation += 360;
+        float radian = car->rotation * 3.14159265f / 180.0f;
+        float new_x = car->x + car->speed * cosf(radian) * SIM_SPEED_SCALE * dt;
+        float new_y = car->y + car->speed * sinf(radian) * SIM_SPEED_SCALE * dt;
+        if (new_x >= tuning->min_x && new_x <= tuning->max_x) car->x = new_x;
+        if (new_y >= tuning->min_y && new_y <= tuning->max_y) car->y = new_y;
+    }
+}
+
+static int bench_vehicles(int argc, char **argv){
+    int count = (int)arg_long(argc, argv, "--vehicles", 100000);
+    int frames = (int)arg_long(argc, argv, "--frames", 600);
+    if (count < 1) count = 1;
+    if (frames < 1) frames = 1;
+
+    VehicleStore store;
+    ScalarCar *scalar = malloc(sizeof *scalar * count);
+    long long *samples = malloc(sizeof *samples * frames);
+    if (vehicles_init(&store, count) != 0 || !scalar || !samples) {
+        fprintf(stderr, "vehicles: could not allocate %d vehicles\n", count);
+        return 1;
+    }
+    store.max_x = SIM_WORLD_WIDTH;
+    store.max_y = SIM_WORLD_HEIGHT;
+    unsigned int rng = 1;
+    for (int i = 0; i < count; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        float x = (rng >> 8) % SIM_WORLD_WIDTH;
+        rng = rng * 1664525u + 1013904223u;
+        float y = (rng >> 8) % SIM_WORLD_HEIGHT;
+        vehicles_add(&store, x, y, (float)(i % 360));
+        scalar[i] = (ScalarCar){x, y, 0, (float)(i % 360), -1, 0, 0};
+    }
+
+    /**
+     * ONE FRAME = TICKS_PER_FRAME TICKS
+     * ---------------------------------
+     * At 60 FPS with a 120 Hz simulation every frame runs two ticks, each one picking
+     * AI controls and moving every car. The frame passes if both fit in 16.7 ms.
+     */
+    unsigned long tick = 0;
+    long long total = 0;
+    for (int f = 0; f < frames; f++) {
+        long long t0 = now_ns();
+        for (int t = 0; t < TICKS_PER_FRAME; t++) {
+            vehicles_drive_ai(&store, 0, store.count, tick++);
+            vehicles_update(&store, 0, store.count, SIM_DT);
+        }
+        samples[f] = now_ns() - t0;
+        total += samples[f];
+    }
+
+    long long scalar_total = 0;
+    tick = 0;
+    for (int f = 0; f < frames; f++) {
+        long long t0 = now_ns();
+        for (int t = 0; t < TICKS_PER_FRAME; t++) {
+            vehicles_drive_ai(&store, 0, store.count, tick++);   // same controls for both
+            for (int i = 0; i < count; i++) {
+                scalar[i].throttle = store.throttle[i];
+                scalar[i].steer = store.steer[i];
+            }
+            scalar_update(scalar, count, &store, SIM_DT);
+        }
+        scalar_total += now_ns() - t0;
+    }
+
+    qsort(samples, frames, sizeof *samples, compare_ll);
+    double frame_ns = (double)total / frames;
+    double ns_per_vehicle = frame_ns / (count * (double)TICKS_PER_FRAME);
+    printf("vehicles: %d cars, %d frames of %d ticks\n", count, frames, TICKS_PER_FRAME);
+    printf("  frame       mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms (budget 16.667 ms)\n",
+           frame_ns / 1e6, samples[frames / 2] / 1e6, samples[frames * 99 / 100] / 1e6, samples[frames - 1] / 1e6);
+    printf("  per car     %.2f ns/update (SoA kernel), %.2f ns/update (scalar baseline), %.1fx\n",
+           ns_per_vehicle, scalar_total / (double)frames / (count * (double)TICKS_PER_FRAME),
+           (double)scalar_total / total);
+    printf("  capacity    ~%.0f cars per 60 FPS frame\n", FRAME_BUDGET_NS / (ns_per_vehicle * TICKS_PER_FRAME));
+
+    int status = samples[frames * 99 / 100] <= FRAME_BUDGET_NS ? 0 : 1;
+    printf("  result      %s\n", status == 0 ? "PASS (p99 within 60 FPS budget)" : "FAIL (p99 over 60 FPS budget)");
+    vehicles_free(&store);
+    free(scalar);
+    free(samples);
+    return status;
+}
+
+// ----------------------------
+// COLLISION
+// ----------------------------
+/**
+ * BROADPHASE SCALING
+ * ------------------
+ * Car-sized boxes are scattered at a fixed density (one per 500x500 px, denser
+ * than the game world), so the world grows with the body count. Each round the
+ * boxes jitter a little, then the spatial hash is rebuilt, pairs are collected and
+ * tested as rotated rectangles. Brute force checks every pair of bounds instead;
+ * both must find exactly the same number of overlapping pairs.
+ *
+ * Then a game's 450 bodies are spread over the default map and over bigger
+ * --world-size maps. Only occupied cells are visited, so the biggest map may cost
+ * at most COLLISION_BENCH_MAP_SLOWDOWN times the default one.
+ */
+#define COLLISION_BENCH_GAME_BODIES 450
+#define COLLISION_BENCH_MAP_SLOWDOWN 3.0
+
+// `side` x `side` world; the mean build + search time goes to `grid_ms`
+static int bench_collision_size(int count, float side, int rounds, int brute_max, double *grid_ms){
+    float radius = sqrtf(60.0f * 60.0f + 30.0f * 30.0f);
+
+    SpatialHash hash;
+    Obb *boxes = malloc(sizeof *boxes * count);
+    if (!boxes || collision_init(&hash, side, side, COLLISION_CELL_SIZE, count) != 0) {
+        fprintf(stderr, "collision: could not allocate %d bodies\n", count);
+        free(boxes);
+        return 1;
+    }
+    unsigned int rng = 7;
+    for (int i = 0; i < count; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        boxes[i].x = (rng >> 8) / 16777216.0f * side;
+        rng = rng * 1664525u + 1013904223u;
+        boxes[i].y = (rng >> 8) / 16777216.0f * side;
+        boxes[i].half_width = 60;
+        boxes[i].half_height = 30;
+        boxes[i].rotation = (float)(i % 360);
+    }
+
+    long long build_ns = 0, pairs_ns = 0, narrow_ns = 0, brute_ns = 0;
+    int pairs = 0, contacts = 0, brute_pairs = -1;
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < count; i++) {
+            rng = rng * 1664525u + 1013904223u;
+            boxes[i].x += (float)((int)(rng >> 28) - 8);
+            boxes[i].y += (float)((int)((rng >> 24) & 15) - 8);
+            hash.min_x[i] = boxes[i].x - radius;
+            hash.min_y[i] = boxes[i].y - radius;
+            hash.max_x[i] = boxes[i].x + radius;
+            hash.max_y[i] = boxes[i].y + radius;
+        }
+        long long t0 = now_ns();
+        collision_build(&hash, count);
+        long long t1 = now_ns();
+        pairs = collision_find_pairs(&hash);
+        long long t2 = now_ns();
+        contacts = 0;
+        for (int p = 0; p < hash.pair_count; p++) {
+            float push_x, push_y;
+            contacts += collision_obb_overlap(boxes[hash.pairs[p].a], boxes[hash.pairs[p].b], &push_x, &push_y);
+        }
+        long long t3 = now_ns();
+        build_ns += t1 - t0;
+        pairs_ns += t2 - t1;
+        narrow_ns += t3 - t2;
+    }
+    if (count <= brute_max) {
+        long long t0 = now_ns();
+        brute_pairs = collision_find_pairs_brute(&hash);
+        brute_ns = now_ns() - t0;
+    }
+
+    *grid_ms = (build_ns + pairs_ns) / 1e6 / rounds;
+    printf("  %6d bodies %6.0fpx  grid %7.3f ms (build %.3f + pairs %.3f)  narrow %.3f ms  %6d pairs %6d contacts",
+           count, side, *grid_ms, build_ns / 1e6 / rounds, pairs_ns / 1e6 / rounds, narrow_ns / 1e6 / rounds, pairs, contacts);
+    if (brute_pairs >= 0) printf("  brute %9.3f ms (%.0fx)", brute_ns / 1e6, brute_ns / 1e6 / *grid_ms);
+    else printf("  brute skipped (> --brute-max)");
+    printf("\n");
+
+    int status = brute_pairs >= 0 && brute_pairs != pairs;
+    if (status) fprintf(stderr, "collision: grid found %d pairs, brute force %d\n", pairs, brute_pairs);
+    collision_free(&hash);
+    free(boxes);
+    return status;
+}
+
+static int bench_collision(int argc, char **argv){
+    int sizes[] = {10000, 25000, 50000, 100000};
+    int only = (int)arg_long(argc, argv, "--bodies", 0);
+    int brute_max = (int)arg_long(argc, argv, "--brute-max", 25000);
+    int status = 0;
+    double grid_ms = 0;
+    printf("collision: spatial hash (%dpx cells) vs brute force, mean of 20 rounds\n", COLLISION_CELL_SIZE);
+    for (int i = 0; i < 4; i++) {
+        if (only > 0 && i > 0) break;
+        int count = only > 0 ? only : sizes[i];
+        status |= bench_collision_size(count, sqrtf(count * 500.0f * 500.0f), 20, brute_max, &grid_ms);
+    }
+    if (only > 0) return status;
+
+    float maps[] = {SIM_WORLD_WIDTH, 60000, 200000};
+    double default_ms = 0;
+    printf("  game bodies by map size, mean of 2000 rounds\n");
+    for (int i = 0; i < 3; i++) {
+        status |= bench_collision_size(COLLISION_BENCH_GAME_BODIES, maps[i], 2000, brute_max, &grid_ms);
+        if (i == 0) default_ms = grid_ms;
+    }
+    int flat = grid_ms <= default_ms * COLLISION_BENCH_MAP_SLOWDOWN;
+    printf("  %.0fpx map costs %.1fx the default one (limit %.0fx): %s\n", maps[2], grid_ms / default_ms,
+           COLLISION_BENCH_MAP_SLOWDOWN, flat ? "PASS" : "FAIL");
+    return status | !flat;
+}
+
+// ----------------------------
+// PROFILER OVERHEAD
+// ----------------------------
+// Replays the timer calls of one game frame (outer phases plus physics, collision
+// and camera for each tick) with nothing in between, so all that is measured is
+// the profiler itself. It must stay far below the frame budget.
+static int bench_profiler(int argc, char **argv){
+    long frames = arg_long(argc, argv, "--frames", 200000);
+    long long t0 = now_ns();
+    for (long f = 0; f < frames; f++) {
+        profiler_frame_begin();
+        prof_begin(PROF_AUDIO);
+        prof_end(PROF_AUDIO);
+        prof_begin(PROF_INPUT);
+        for (int t = 0; t < TICKS_PER_FRAME; t++) {
+            prof_begin(PROF_PHYSICS);
+            prof_end(PROF_PHYSICS);
+            prof_begin(PROF_COLLISION);
+            prof_end(PROF_COLLISION);
+            prof_begin(PROF_CAMERA);
+            prof_end(PROF_CAMERA);
+        }
+        prof_end(PROF_INPUT);
+        prof_begin(PROF_DRAW);
+        prof_end(PROF_DRAW);
+        prof_begin(PROF_PRESENT);
+        prof_end(PROF_PRESENT);
+        profiler_frame_end();
+    }
+    double per_frame_ns = (double)(now_ns() - t0) / frames;
+    double budget_share = per_frame_ns / FRAME_BUDGET_NS * 100;
+    int status = budget_share > 0.1;
+    printf("profiler: %ld frames, %.0f ns of timers per frame (%.4f%% of a 60 FPS frame)  %s\n",
+           frames, per_frame_ns, budget_share, status ? "FAIL" : "PASS");
+    return status;
+}
+
+// ----------------------------
+// CHUNK STREAMING
+// ----------------------------
+/**
+ * FLY-OVER
+ * --------
+ * The view crosses the world diagonally at the car's top speed (6000 px/s) for
+ * --frames frames, paced at 60 FPS so the worker gets the same time it would in
+ * the game. Each frame does what the render thread does (queue, take finished
+ * chunks) and counts visible chunks that are not ready. Runs once with velocity
+ * prefetch and once with only the visible area requested, under a small cache so
+ * chunks are evicted and rebuilt along the way.
+ */
+static int bench_world_pass(long frames, int cache_mb, int prefetch, unsigned long *late_frames){
+    World world;
+    if (world_init(&world, 2024, cache_mb) != 0) {
+        fprintf(stderr, "world: could not allocate the chunk cache\n");
+        return 1;
+    }
+    const float speed = 6000;   // vehicles max_speed * SIM_SPEED_SCALE
+    const float velocity_x = speed * 0.8f, velocity_y = speed * 0.6f;
+    SimRect view = {0, 0, 1300, 1000};
+    int slots[64];
+
+    // The game starts streaming while the menu is up; give the first view a moment
+    world_update(&world, view, 0, 0);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += 100000000;
+    for (long f = 0; f < frames; f++) {
+        deadline.tv_nsec += FRAME_BUDGET_NS;
+        while (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_nsec -= 1000000000;
+            deadline.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        view.x += velocity_x / 60;
+        view.y += velocity_y / 60;
+        long long t0 = now_ns();
+        world_update(&world, view, prefetch ? velocity_x : 0, prefetch ? velocity_y : 0);
+        while (world_take_ready(&world, slots, 64) == 64) {}
+        long long stream_ns = now_ns() - t0;
+
+        int missing = 0;
+        for (int cy = (int)floorf(view.y / WORLD_CHUNK_SIZE); cy <= (int)floorf((view.y + view.height) / WORLD_CHUNK_SIZE); cy++) {
+            for (int cx = (int)floorf(view.x / WORLD_CHUNK_SIZE); cx <= (int)floorf((view.x + view.width) / WORLD_CHUNK_SIZE); cx++) {
+                const Chunk *chunk = world_chunk(&world, cx, cy);
+                if (!chunk || chunk->state != CHUNK_READY) missing++;
+            }
+        }
+        world_end_frame(&world, missing, stream_ns);
+    }
+
+    WorldStats *stats = &world.stats;
+    printf("  %-12s %4lu/%lu late frames, %4lu holes, worst streaming %.3f ms, %lu built, %lu evicted\n",
+           prefetch ? "prefetch" : "border only", stats->missed_frames, stats->frames, stats->missing_chunks,
+           stats->worst_stream_ns / 1e6, stats->generated, stats->evicted);
+    *late_frames = stats->missed_frames;
+    world_free(&world);
+    return 0;
+}
+
+static int bench_world(int argc, char **argv){
+    long frames = arg_long(argc, argv, "--frames", 240);
+    int cache_mb = (int)arg_long(argc, argv, "--chunk-cache-mb", 1);
+    World probe;
+    if (world_init(&probe, 0, cache_mb) != 0) return 1;
+    printf("world: %dpx chunks, %d slots in a %d MB cache, flying at 6000 px/s for %ld frames\n",
+           WORLD_CHUNK_SIZE, probe.slot_count, cache_mb, frames);
+    world_free(&probe);
+
+    unsigned long late = 0, late_without = 0;
+    int status = bench_world_pass(frames, cache_mb, 1, &late);
+    status |= bench_world_pass(frames, cache_mb, 0, &late_without);
+    int fail = late * 100 > (unsigned long)frames;   // Prefetch must keep holes under 1% of frames
+    printf("  %s\n", fail ? "FAIL" : "PASS");
+    return status | fail;
+}
+
+// ----------------------------
+// FRAME PACING
+// ----------------------------
+// Paces --frames frames of about 1 ms of work at several targets (165 is not a
+// preset), once with the hybrid pacer and once sleeping straight to each deadline,
+// and compares the frame-interval jitter. Input is "read" before each frame's work,
+// so the latency is that work plus the pacing wait. Fails if a target is not kept
+// as given, or if hybrid pacing misses its target rate by more than 2% at 60 FPS.
+static void pacing_work(void){
+    long long until = now_ns() + 1000000;
+    while (now_ns() < until) {}
+}
+
+static int bench_pacing(int argc, char **argv){
+    long frames = arg_long(argc, argv, "--frames", 120);
+    static const int targets[] = {60, 144, 165, 240};
+    int status = 0;
+    printf("pacing: %ld frames per target, 1 ms of work per frame\n", frames);
+    for (int t = 0; t < 4; t++) {
+        Pacer pacer;
+        pacing_init(&pacer, PACING_HYBRID, targets[t]);
+        if (pacer.target_fps != targets[t]) status = 1;
+        for (long f = 0; f < frames; f++) {
+            pacing_input_sampled(&pacer);
+            pacing_work();
+            pacing_wait(&pacer);
+            pacing_presented(&pacer);
+        }
+        PacingStats hybrid;
+        pacing_stats(&pacer, &hybrid);
+
+        // Same schedule, but sleeping all the way to the deadline
+        Pacer sleeper;
+        pacing_init(&sleeper, PACING_UNCAPPED, targets[t]);
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        for (long f = 0; f < frames; f++) {
+            pacing_work();
+            deadline.tv_nsec += 1000000000L / targets[t];
+            while (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_nsec -= 1000000000;
+                deadline.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+            pacing_presented(&sleeper);
+        }
+        PacingStats sleep_only;
+        pacing_stats(&sleeper, &sleep_only);
+
+        printf("  %3d FPS  hybrid %7.2f FPS, jitter %.3f ms (spin %.2f ms), input to present %.2f ms (p99 %.2f ms)"
+               "   sleep only %7.2f FPS, jitter %.3f ms\n", pacer.target_fps, hybrid.fps, hybrid.jitter_ms,
+               pacer.spin_ns / 1e6, hybrid.latency_ms, hybrid.latency_p99_ms, sleep_only.fps, sleep_only.jitter_ms);
+        if (targets[t] == 60 && fabs(hybrid.fps - 60) > 60 * 0.02) status = 1;
+    }
+    printf("  %s\n", status ? "FAIL" : "PASS");
+    return status;
+}
+
+// ----------------------------
+// AUDIO COMMAND QUEUE
+// ----------------------------
+// One thread pushes --commands numbered commands, another pops them, as the game
+// and audio threads do. Every command must arrive exactly once and in order; the
+// push cost is what the game thread pays per sound or music change. Both sides
+// yield when they cannot make progress so the bench also works on one core.
+typedef struct {
+    AudioQueue queue;
+    long count;
+    long errors;
+} QueueBench;
+
+static void *queue_consumer(void *arg){
+    QueueBench *bench = arg;
+    long expected = 0;
+    while (expected < bench->count) {
+        AudioCommand command;
+        if (!audio_queue_pop(&bench->queue, &command)) { sched_yield(); continue; }
+        if (command.target != (int)expected) bench->errors++;
+        expected++;
+    }
+    return NULL;
+}
+
+static int bench_audio(int argc, char **argv){
+    static QueueBench bench;
+    bench.count = arg_long(argc, argv, "--commands", 1000000);
+    bench.errors = 0;
+    audio_queue_init(&bench.queue);
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, queue_consumer, &bench) != 0) return 1;
+    long full = 0;
+    long long t0 = now_ns();
+    for (long i = 0; i < bench.count; i++) {
+        AudioCommand command = {AUDIO_PLAY_SOUND, (int)i, 0};
+        while (!audio_queue_push(&bench.queue, command)) { full++; sched_yield(); }
+    }
+    pthread_join(consumer, NULL);
+    long long elapsed = now_ns() - t0;
+    int status = bench.errors != 0;
+    printf("audio: %ld commands through a %d-slot queue in %.1f ms (%.1f ns/command), %ld pushes hit a full queue, %ld out of order  %s\n",
+           bench.count, AUDIO_QUEUE_CAPACITY, elapsed / 1e6, (double)elapsed / bench.count, full, bench.errors,
+           status ? "FAIL" : "PASS");
+    return status;
+}
+
+// ----------------------------
+// JOB SYSTEM SCALING
+// ----------------------------
+/**
+ * SAME WORK, MORE THREADS
+ * -----------------------
+ * Each workload runs with 1, 2, ... --max-threads threads in the pool: 200k cars
+ * steered and moved, the broadphase over 50k bodies, the broadphase over a
+ * game's 450 bodies on the game's world, 256 terrain chunks built by the world
+ * streamer, a 20k-car simulation and 100k empty jobs (pure scheduling cost).
+ * Every result is hashed and must match the single-thread run; the parallel
+ * paths are meant to be bit-identical. The broadphase is always split here, and
+ * with one thread it is the serial search, so the game-size column shows whether
+ * the simulation is right to search its few hundred bodies on one thread.
+ */
+#define JOBS_BENCH_CARS 200000
+#define JOBS_BENCH_BODIES 50000
+#define JOBS_BENCH_GAME_BODIES 450
+#define JOBS_BENCH_CHUNK_SIDE 16
+#define JOBS_BENCH_SIM_CARS 20000
+#define JOBS_BENCH_EMPTY 100000
+
+typedef struct {
+    double cars_ms, pairs_ms, game_pairs_us, chunks_ms, sim_ms, empty_ns;   // Per frame / search / search / batch / tick / job
+    unsigned int cars_hash, pairs_hash, game_pairs_hash, chunks_hash, sim_hash;
+} JobsResult;
+
+static unsigned int fnv(unsigned int hash, const void *data, size_t size){
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+typedef struct {
+    VehicleStore *store;
+    unsigned long tick;
+} CarsJob;
+
+static void cars_steer_job(void *data, int begin, int end){
+    CarsJob *job = data;
+    vehicles_drive_ai(job->store, begin, end, job->tick);
+}
+
+static void cars_move_job(void *data, int begin, int end){
+    CarsJob *job = data;
+    vehicles_update(job->store, begin, end, SIM_DT);
+}
+
+static void empty_job(void *data, int begin, int end){
+    (void)data; (void)begin; (void)end;
+}
+
+static int jobs_cars(JobsResult *result){
+    VehicleStore store;
+    if (vehicles_init(&store, JOBS_BENCH_CARS) != 0) return -1;
+    store.max_x = SIM_WORLD_WIDTH;
+    store.max_y = SIM_WORLD_HEIGHT;
+    unsigned int rng = 1;
+    for (int i = 0; i < JOBS_BENCH_CARS; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        float x = (rng >> 8) % SIM_WORLD_WIDTH;
+        rng = rng * 1664525u + 1013904223u;
+        vehicles_add(&store, x, (rng >> 8) % SIM_WORLD_HEIGHT, (float)(i % 360));
+    }
+    const int frames = 60;
+    CarsJob job = {&store, 0};
+    long long t0 = now_ns();
+    for (int f = 0; f < frames * TICKS_PER_FRAME; f++) {
+        JobCounter steered = {0}, moved = {0};
+        jobs_run(cars_steer_job, &job, 0, store.count, 4096, NULL, &steered);
+        jobs_run(cars_move_job, &job, 0, store.count, 4096, &steered, &moved);
+        jobs_wait(&steered);
+        jobs_wait(&moved);
+        job.tick++;
+    }
+    result->cars_ms = (now_ns() - t0) / 1e6 / frames;
+    result->cars_hash = fnv(fnv(2166136261u, store.x, sizeof(float) * store.count), store.y, sizeof(float) * store.count);
+    vehicles_free(&store);
+    return 0;
+}
+
+// Times the broadphase over `count` bodies scattered on a `side` x `side` world
+static int jobs_pairs(int count, float side, int rounds, double *us, unsigned int *hash_out){
+    float radius = sqrtf(60.0f * 60.0f + 30.0f * 30.0f);
+    SpatialHash hash;
+    Arena scratch;
+    if (collision_init(&hash, side, side, COLLISION_CELL_SIZE, count) != 0) return -1;
+    if (arena_init(&scratch, 64 * 1024) != 0) {
+        collision_free(&hash);
+        return -1;
+    }
+    unsigned int rng = 7;
+    for (int i = 0; i < count; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        float x = (rng >> 8) / 16777216.0f * side;
+        rng = rng * 1664525u + 1013904223u;
+        float y = (rng >> 8) / 16777216.0f * side;
+        hash.min_x[i] = x - radius;
+        hash.min_y[i] = y - radius;
+        hash.max_x[i] = x + radius;
+        hash.max_y[i] = y + radius;
+    }
+    collision_build(&hash, count);
+    long long total = 0;
+    for (int r = 0; r < rounds; r++) {
+        arena_reset(&scratch);   // The first rounds also grow the arena to fit
+        long long t0 = now_ns();
+        collision_find_pairs_parallel(&hash, &scratch, 0);   // Always split, to measure what splitting costs
+        total += now_ns() - t0;
+    }
+    *us = total / 1e3 / rounds;
+    *hash_out = fnv(2166136261u, hash.pairs, sizeof(BodyPair) * hash.pair_count);
+    arena_free(&scratch);
+    collision_free(&hash);
+    return 0;
+}
+
+static int jobs_chunks(JobsResult *result){
+    World world;
+    if (world_init(&world, 2024, 64) != 0) return -1;
+    const int side = JOBS_BENCH_CHUNK_SIDE;
+    SimRect view = {0, 0, side * WORLD_CHUNK_SIZE - 1, side * WORLD_CHUNK_SIZE - 1};
+    int slots[64];
+    long long t0 = now_ns();
+    world_update(&world, view, 0, 0);
+    int ready = 0;
+    while (ready < side * side) {
+        while (world_take_ready(&world, slots, 64) > 0) {}
+        ready = 0;
+        for (int cy = 0; cy < side; cy++) {
+            for (int cx = 0; cx < side; cx++) {
+                const Chunk *chunk = world_chunk(&world, cx, cy);
+                ready += chunk && chunk->state == CHUNK_READY;
+            }
+        }
+        if (ready < side * side) sched_yield();
+    }
+    result->chunks_ms = (now_ns() - t0) / 1e6;
+    unsigned int h = 2166136261u;
+    for (int cy = 0; cy < side; cy++) {
+        for (int cx = 0; cx < side; cx++) {
+            const Chunk *chunk = world_chunk(&world, cx, cy);
+            h = fnv(h, chunk->pixels, WORLD_CHUNK_TEXELS * WORLD_CHUNK_TEXELS * 4);
+        }
+    }
+    result->chunks_hash = h;
+    world_free(&world);
+    return 0;
+}
+
+static int jobs_sim(JobsResult *result){
+    SimState sim;
+    if (sim_init(&sim, SIM_WORLD_WIDTH * 4, SIM_WORLD_HEIGHT * 4, 1300, 1000, 120, 60, JOBS_BENCH_SIM_CARS) != 0) return -1;
+    const int ticks = 240;
+    long long t0 = now_ns();
+    for (int t = 0; t < ticks; t++) sim_step(&sim, t % 240 < 120 ? SIM_INPUT_UP : SIM_INPUT_UP | SIM_INPUT_LEFT);
+    result->sim_ms = (now_ns() - t0) / 1e6 / ticks;
+    result->sim_hash = sim_hash(&sim);
+    sim_free(&sim);
+    return 0;
+}
+
+static int bench_jobs(int argc, char **argv){
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = (int)arg_long(argc, argv, "--max-threads", cores);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > JOBS_MAX_THREADS) max_threads = JOBS_MAX_THREADS;
+    int restore = jobs_thread_count();
+    printf("jobs: work-stealing pool, 1 to %d threads on %d cores (speedup vs 1 thread)\n", max_threads, cores);
+    printf("  threads  %dk cars/frame   broadphase %dk   broadphase %d   %d chunks        sim %dk cars/tick  empty job\n",
+           JOBS_BENCH_CARS / 1000, JOBS_BENCH_BODIES / 1000, JOBS_BENCH_GAME_BODIES,
+           JOBS_BENCH_CHUNK_SIDE * JOBS_BENCH_CHUNK_SIDE, JOBS_BENCH_SIM_CARS / 1000);
+
+    JobsResult base = {0};
+    double best_game_us = 1e30;
+    int best_game_threads = 0;
+    int status = 0;
+    for (int threads = 1; threads <= max_threads; threads++) {
+        JobsResult r = {0};
+        double pairs_us;
+        if (jobs_init(threads) != 0 || jobs_cars(&r) != 0 ||
+            jobs_pairs(JOBS_BENCH_BODIES, sqrtf(JOBS_BENCH_BODIES * 500.0f * 500.0f), 20, &pairs_us, &r.pairs_hash) != 0 ||
+            jobs_pairs(JOBS_BENCH_GAME_BODIES, SIM_WORLD_WIDTH, 2000, &r.game_pairs_us, &r.game_pairs_hash) != 0 ||
+            jobs_chunks(&r) != 0 || jobs_sim(&r) != 0) {
+            fprintf(stderr, "jobs: could not run with %d threads\n", threads);
+            status = 1;
+            break;
+        }
+        long long t0 = now_ns();
+        parallel_for(0, JOBS_BENCH_EMPTY, 1, empty_job, NULL);
+        r.empty_ns = (double)(now_ns() - t0) / JOBS_BENCH_EMPTY;
+        r.pairs_ms = pairs_us / 1e3;
+        if (threads == 1) base = r;
+        int same = r.cars_hash == base.cars_hash && r.pairs_hash == base.pairs_hash &&
+                   r.game_pairs_hash == base.game_pairs_hash && r.chunks_hash == base.chunks_hash &&
+                   r.sim_hash == base.sim_hash;
+        printf("  %7d  %6.2f ms %4.1fx   %6.2f ms %4.1fx   %5.1f us %4.1fx   %6.1f ms %4.1fx   %6.2f ms %4.1fx   %5.0f ns  %s\n",
+               threads, r.cars_ms, base.cars_ms / r.cars_ms, r.pairs_ms, base.pairs_ms / r.pairs_ms,
+               r.game_pairs_us, base.game_pairs_us / r.game_pairs_us, r.chunks_ms, base.chunks_ms / r.chunks_ms,
+               r.sim_ms, base.sim_ms / r.sim_ms, r.empty_ns, same ? "same results" : "RESULTS DIFFER");
+        if (threads > 1 && r.game_pairs_us < best_game_us) {
+            best_game_us = r.game_pairs_us;
+            best_game_threads = threads;
+        }
+        status |= !same;
+    }
+    JobStats stats;
+    jobs_stats(&stats);
+    printf("  %lu jobs run, %lu stolen, %lu ranges run inline\n", stats.executed, stats.stolen, stats.inline_runs);
+    if (best_game_threads)
+        printf("  %d-body broadphase: %.1f us on one thread, %.1f us at best split (%d threads): %s\n",
+               JOBS_BENCH_GAME_BODIES, base.game_pairs_us, best_game_us, best_game_threads,
+               best_game_us < base.game_pairs_us ? "splitting wins, lower the sim's threshold" : "serial wins, as the sim does");
+    printf("  %s\n", status ? "FAIL" : "PASS");
+    jobs_init(restore);
+    return status;
+}
+
+// ----------------------------
+// LOOPBACK MULTIPLAYER
+// ----------------------------
+/**
+ * SERVER PROCESS + SCRIPTED CLIENTS
+ * ---------------------------------
+ * A server is forked (the profiler the simulation reports to is not shared
+ * between threads, and the game runs it as its own process anyway), then
+ * --clients clients in this process drive it in real time at the tick rate:
+ * first over a clean link, then with --net-lag and --net-loss added on every
+ * client socket. All clients follow the same input script side by side, so
+ * their cars rarely touch and the corrections show what the link costs, not
+ * collisions. Every client must stay connected, keep receiving snapshots and
+ * get deltas smaller than a full snapshot, and on the clean link its
+ * predictions must need no correction on average.
+ */
+#define NET_BENCH_CLIENTS 3
+
+typedef struct {
+    double down_rate, up_rate;      // Per client, bytes per second
+    double snapshot_bytes;          // Average received
+    int full_bytes;                 // What a full snapshot of the same world costs
+    unsigned long snapshots, full_snapshots, stale;
+    double correction_mean, correction_max;
+    double rtt_ms;
+    int failed;
+} NetBenchResult;
+
+static int net_bench_pass(int clients, double seconds, int port, NetConditions conditions, NetBenchResult *result){
+    memset(result, 0, sizeof *result);
+    NetServerOptions options;
+    net_server_default_options(&options);
+    options.port = port;
+    options.seconds = (int)seconds + 10;   // Killed once the clients are done
+    options.verbose = 0;
+    fflush(stdout);
+    pid_t server = fork();
+    if (server < 0) return -1;
+    if (server == 0) _exit(net_server_run(&options));
+
+    static NetClient net[NET_BENCH_CLIENTS];
+    static SimState sims[NET_BENCH_CLIENTS];
+    int connected = 0;
+    while (connected < clients && net_client_connect(&net[connected], "127.0.0.1", port, &conditions, 2000) == 0) {
+        if (net_client_init_sim(&net[connected], &sims[connected], 1300, 1000) != 0) {
+            net_client_close(&net[connected]);
+            break;
+        }
+        connected++;
+    }
+    if (connected == clients) {
+        const long long tick_ns = 1000000000LL / SIM_TICK_RATE;
+        long long start = now_ns(), next = start;
+        unsigned int rng = 7, input = 0;
+        for (long tick = 0; now_ns() - start < (long long)(seconds * 1e9); tick++) {
+            if (tick % (SIM_TICK_RATE / 2) == 0) {   // New keys every half second
+                rng = rng * 1664525u + 1013904223u;
+                input = (rng >> 8) % 4 ? SIM_INPUT_UP : 0;
+                input |= (rng >> 12) % 3 == 0 ? SIM_INPUT_LEFT : (rng >> 12) % 3 == 1 ? SIM_INPUT_RIGHT : 0;
+            }
+            for (int c = 0; c < clients; c++) {
+                net_client_tick(&net[c], &sims[c], input);
+                if (net_client_update(&net[c], &sims[c]) != 0) result->failed = 1;
+            }
+            next += tick_ns;
+            long long wait = next - now_ns();
+            if (wait > 0) {
+                struct timespec ts = {wait / 1000000000LL, wait % 1000000000LL};
+                nanosleep(&ts, NULL);
+            }
+        }
+        double elapsed = (now_ns() - start) / 1e9;
+        for (int c = 0; c < clients; c++) {
+            NetClient *client = &net[c];
+            const NetClientStats *stats = &client->stats;
+            result->down_rate += client->socket.bytes_received / elapsed / clients;
+            result->up_rate += client->socket.bytes_sent / elapsed / clients;
+            result->snapshots += stats->snapshots;
+            result->full_snapshots += stats->full_snapshots;
+            result->stale += stats->stale_snapshots;
+            result->snapshot_bytes += (double)stats->snapshot_bytes / (stats->snapshots ? stats->snapshots : 1) / clients;
+            if (stats->snapshots > 1) result->correction_mean += stats->correction_sum / (stats->snapshots - 1) / clients;
+            if (stats->correction_max > result->correction_max) result->correction_max = stats->correction_max;
+            result->rtt_ms += stats->rtt_ms / clients;
+            // Expect at least half the snapshots the server sent in that time
+            if (stats->snapshots < elapsed * SIM_TICK_RATE / NET_SNAPSHOT_INTERVAL / 2) result->failed = 1;
+        }
+        unsigned char packet[NET_MAX_PACKET];
+        result->full_bytes = net_write_snapshot(packet, &net[0].snapshots[0], NULL, 0);
+        for (int i = 0; i < NET_SNAPSHOT_HISTORY; i++) {
+            if (net[0].snapshots[i].tick == net[0].latest_tick) result->full_bytes = net_write_snapshot(packet, &net[0].snapshots[i], NULL, 0);
+        }
+    } else {
+        result->failed = 1;
+    }
+    for (int c = 0; c < connected; c++) {
+        net_client_close(&net[c]);
+        sim_free(&sims[c]);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    return 0;
+}
+
+// ----------------------------
+// GHOST TRAJECTORIES
+// ----------------------------
+/**
+ * ONE LONG DRIVE, MANY GHOSTS
+ * ---------------------------
+ * An autopilot laps the gate course for --minutes through the normal world
+ * (traffic and obstacles included, so there are collisions to encode), lifting
+ * off for the corners and now and then for no reason, the way a player does.
+ * Each lap is recorded as its own ghost, as the game does, and the whole drive
+ * as one long ghost. The suite reports their size against the raw 12 bytes per
+ * tick, checks every decoded tick of the long one against what was recorded,
+ * times random seeks and loading a folder of saved copies, then times what a
+ * frame costs the game with 1, 10 and 100 ghosts on screen: moving every cursor
+ * to the lap clock and building the batch of quads ghost_draw() hands to the GPU.
+ */
+#define GHOSTS_BENCH_MAX 100
+#define GHOSTS_BENCH_FRAMES 7200      // One minute at 120 FPS
+#define GHOSTS_BENCH_SEEKS 10000
+#define GHOSTS_BENCH_BYTES_PER_MINUTE 1200   // Size budget, stream and index: a 10 min ghost under 12 KB
+
+// Steers at the next gate; lifts when it points well off it or, for a moment, at random,
+// and backs out for half a second when it is stuck against a box or a car
+typedef struct {
+    unsigned int rng;
+    long lift, stuck, reverse;
+} GhostsAutopilot;
+
+static unsigned int ghosts_autopilot(GhostsAutopilot *pilot, const SimState *sim, const LapCourse *course,
+                                     const LapTimer *timer){
+    int car = sim->focus;
+    if (pilot->reverse > 0) {
+        pilot->reverse--;
+        return SIM_INPUT_DOWN | SIM_INPUT_LEFT;
+    }
+    pilot->stuck = fabsf(sim->vehicles.speed[car]) < 2 ? pilot->stuck + 1 : 0;
+    if (pilot->stuck > SIM_TICK_RATE / 2) {
+        pilot->stuck = 0;
+        pilot->reverse = SIM_TICK_RATE / 2;
+    }
+    float dx = course->x[timer->next_gate] - sim->vehicles.x[car];
+    float dy = course->y[timer->next_gate] - sim->vehicles.y[car];
+    float off = fmodf(atan2f(dy, dx) * (180.0f / 3.14159265f) - sim->vehicles.rotation[car] + 540.0f, 360.0f) - 180.0f;
+    unsigned int input = off > 2 ? SIM_INPUT_RIGHT : off < -2 ? SIM_INPUT_LEFT : 0;
+    pilot->rng = pilot->rng * 1664525u + 1013904223u;
+    if (pilot->lift > 0) pilot->lift--;
+    else if ((pilot->rng >> 8) % SIM_TICK_RATE == 0) pilot->lift = (pilot->rng >> 16) % (SIM_TICK_RATE / 2);   // About once a second
+    if (pilot->lift == 0 && fabsf(off) < 35) input |= SIM_INPUT_UP;
+    return input;
+}
+
+static int bench_ghosts(int argc, char **argv){
+    long minutes = arg_long(argc, argv, "--minutes", 10);
+    long ticks = (minutes < 1 ? 1 : minutes) * 60 * SIM_TICK_RATE;
+    float *path = malloc(sizeof(float) * 3 * ticks);
+    SimState sim;
+    if (!path || sim_init(&sim, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT, 1300, 1000, 120, 59, SIM_TRAFFIC_COUNT) != 0) {
+        free(path);
+        return 1;
+    }
+    LapCourse course;
+    LapTimer timer;
+    lap_course_init(&course, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT);
+    lap_timer_init(&timer);
+    Ghost ghost, lap = {0};
+    ghost_begin(&ghost, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT);
+    GhostsAutopilot pilot = {.rng = 99};
+    size_t lap_bytes = 0;
+    int status = 0;
+    long long t0 = now_ns();
+    for (long t = 0; t < ticks; t++) {
+        sim_step(&sim, ghosts_autopilot(&pilot, &sim, &course, &timer));
+        float *sample = &path[3 * t];
+        sample[0] = sim.vehicles.x[SIM_PLAYER];
+        sample[1] = sim.vehicles.y[SIM_PLAYER];
+        sample[2] = sim.vehicles.rotation[SIM_PLAYER];
+        if (ghost_record(&ghost, sample[0], sample[1], sample[2]) != 0) status = 1;
+        unsigned int events = lap_timer_update(&timer, &course, &sim);
+        if (events & LAP_EVENT_FINISH) {
+            ghost_finish(&lap);
+            lap_bytes += ghost_memory(&lap);
+        }
+        if (events & (LAP_EVENT_START | LAP_EVENT_FINISH)) {
+            ghost_free(&lap);
+            ghost_begin(&lap, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT);
+        }
+        if (timer.started && ghost_record(&lap, sample[0], sample[1], sample[2]) != 0) status = 1;
+    }
+    ghost_finish(&ghost);
+    ghost_free(&lap);
+    double record_ns = (double)(now_ns() - t0) / ticks;   // Simulation included
+    sim_free(&sim);
+
+    // Every tick in order, as a ghost racing alongside would see it
+    double worst_position = 0, worst_rotation = 0;
+    GhostCursor cursor = {.tick = -1};
+    t0 = now_ns();
+    for (long t = 0; t < ticks; t++) {
+        ghost_advance(&ghost, &cursor, t);
+        GhostPose pose = ghost_pose(&cursor, 1);
+        const float *sample = &path[3 * t];
+        double position = hypot(pose.x - sample[0], pose.y - sample[1]);
+        double rotation = fabs(fmod(pose.rotation - sample[2] + 540.0, 360.0) - 180.0);
+        if (position > worst_position) worst_position = position;
+        if (rotation > worst_rotation) worst_rotation = rotation;
+    }
+    double play_ns = (double)(now_ns() - t0) / ticks;
+    t0 = now_ns();
+    for (int i = 0; i < GHOSTS_BENCH_SEEKS; i++) {
+        pilot.rng = pilot.rng * 1664525u + 1013904223u;
+        ghost_seek(&ghost, &cursor, (long)((pilot.rng >> 4) % ticks));
+    }
+    double seek_us = (now_ns() - t0) / 1e3 / GHOSTS_BENCH_SEEKS;
+
+    size_t memory = ghost_memory(&ghost);
+    size_t budget = (size_t)(ticks / (60 * SIM_TICK_RATE)) * GHOSTS_BENCH_BYTES_PER_MINUTE;
+    printf("ghosts: %d laps of the course, best %.2f s, %.0f B per lap ghost\n", timer.laps,
+           timer.best_lap / (double)SIM_TICK_RATE, timer.laps ? (double)lap_bytes / timer.laps : 0.0);
+    printf("  whole %ld min drive: %zu B stream + %d keyframes = %.1f KB (budget %.1f KB), %.3f B/tick vs %zu raw (%.0fx smaller)\n",
+           minutes, ghost.size, ghost.key_count, memory / 1024.0, budget / 1024.0, (double)ghost.size / ticks,
+           3 * sizeof(float), 3.0 * sizeof(float) * ticks / memory);
+    printf("  recording %.0f ns/tick with the simulation\n", record_ns);
+    printf("  worst error %.3f px, %.3f deg; playback %.1f ns/tick, random seek %.2f us\n",
+           worst_position, worst_rotation, play_ns, seek_us);
+    // The recorder checks in float, so allow its rounding on top of the tolerances
+    if (worst_position > GHOST_POSITION_TOLERANCE * 1.001 || worst_rotation > GHOST_ROTATION_TOLERANCE * 1.001) status = 1;
+    if (memory > budget) status = 1;
+
+    // A folder of saved laps, loaded the way the game does at startup
+    char dir[64];
+    snprintf(dir, sizeof dir, "/tmp/raceee_ghosts_%d", (int)getpid());
+    static Ghost loaded[GHOSTS_BENCH_MAX];
+    mkdir(dir, 0755);
+    for (int i = 0; i < GHOSTS_BENCH_MAX; i++) {
+        char file[128];
+        snprintf(file, sizeof file, "%s/lap_%03d.rgh", dir, i);
+        if (ghost_save(&ghost, file) != 0) status = 1;
+    }
+    t0 = now_ns();
+    int count = ghost_load_dir(loaded, GHOSTS_BENCH_MAX, dir, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT);
+    double load_ms = (now_ns() - t0) / 1e6;
+    for (int i = 0; i < GHOSTS_BENCH_MAX; i++) {
+        char file[128];
+        snprintf(file, sizeof file, "%s/lap_%03d.rgh", dir, i);
+        remove(file);
+    }
+    rmdir(dir);
+    printf("  loading %d ghosts from disk: %.2f ms\n", count, load_ms);
+    if (count != GHOSTS_BENCH_MAX || timer.laps == 0) status = 1;
+
+    // Ghosts spread over the lap so every cursor decodes different ticks
+    static GhostCursor cursors[GHOSTS_BENCH_MAX];
+    static GhostPose poses[GHOSTS_BENCH_MAX];
+    static GhostQuad quads[GHOSTS_BENCH_MAX];
+    const int sizes[] = {1, 10, GHOSTS_BENCH_MAX};
+    printf("  ghosts  per frame   per ghost   (advance to the lap clock + pose + quad)\n");
+    for (int k = 0; k < 3; k++) {
+        int n = sizes[k];
+        long offset = ticks / n;
+        for (int i = 0; i < n; i++) ghost_seek(&loaded[i], &cursors[i], i * offset);
+        t0 = now_ns();
+        for (long frame = 1; frame <= GHOSTS_BENCH_FRAMES; frame++) {
+            for (int i = 0; i < n; i++) {
+                ghost_advance(&loaded[i], &cursors[i], (i * offset + frame) % ticks);
+                poses[i] = ghost_pose(&cursors[i], 0.5f);
+            }
+            ghost_build_quads(poses, n, 120, 59, quads);
+        }
+        double frame_ns = (double)(now_ns() - t0) / GHOSTS_BENCH_FRAMES;
+        printf("  %6d  %7.2f us  %7.1f ns\n", n, frame_ns / 1e3, frame_ns / n);
+    }
+    for (int i = 0; i < count; i++) ghost_free(&loaded[i]);
+    ghost_free(&ghost);
+    free(path);
+    printf("  %s\n", status ? "FAIL" : "PASS");
+    return status;
+}
+
+static int bench_net(int argc, char **argv){
+    int clients = (int)arg_long(argc, argv, "--clients", NET_BENCH_CLIENTS);
+    if (clients < 1) clients = 1;
+    if (clients > NET_BENCH_CLIENTS) clients = NET_BENCH_CLIENTS;
+    double seconds = arg_long(argc, argv, "--seconds", 4);
+    int port = (int)arg_long(argc, argv, "--port", NET_DEFAULT_PORT + 1);
+    NetConditions bad = {(int)arg_long(argc, argv, "--net-lag", 100), (int)arg_long(argc, argv, "--net-loss", 5)};
+    NetConditions links[2] = {{0, 0}, bad};
+
+    // The forked server must not inherit a pool whose threads it would not have
+    int restore = jobs_thread_count();
+    jobs_shutdown();
+    printf("net: %d clients and a server process on 127.0.0.1, %.0f s per link, %d snapshots/s\n",
+           clients, seconds, SIM_TICK_RATE / NET_SNAPSHOT_INTERVAL);
+    printf("  link              down/client  up/client  snapshot (full)   full  stale  correction mean/max  rtt\n");
+    int status = 0;
+    for (int l = 0; l < 2; l++) {
+        NetBenchResult r;
+        char name[32];
+        snprintf(name, sizeof name, l ? "%d ms, %d%% loss" : "clean", links[l].lag_ms, links[l].loss_percent);
+        if (net_bench_pass(clients, seconds, port, links[l], &r) != 0) r.failed = 1;
+        int ok = !r.failed && r.snapshot_bytes < r.full_bytes && (l > 0 || r.correction_mean < 1.0);
+        printf("  %-16s  %6.2f KB/s  %5.2f KB/s  %4.1f B (%3d B)  %5lu  %5lu  %6.2f / %6.2f px  %4.0f ms  %s\n",
+               name, r.down_rate / 1024, r.up_rate / 1024, r.snapshot_bytes, r.full_bytes, r.full_snapshots, r.stale,
+               r.correction_mean, r.correction_max, r.rtt_ms, ok ? "ok" : "FAIL");
+        status |= !ok;
+    }
+    printf("  %s\n", status ? "FAIL" : "PASS");
+    jobs_init(restore);
+    return status;
+}
+
+int main(int argc, char **argv){
+    const char *suite = argc > 1 && argv[1][0] != '-' ? argv[1] : "all";
+    int all = strcmp(suite, "all") == 0;
+    int status = 0;
+    if (jobs_init((int)arg_long(argc, argv, "--threads", 1)) != 0) fprintf(stderr, "Could not start the job system, running single-threaded\n");
+
+    if (all || strcmp(suite, "sim") == 0) {
+        HeadlessOptions options;
+        headless_default_options(&options);
+        headless_parse_args(&options, argc, argv);
+        status |= headless_run(&options);
+    }
+    if (all || strcmp(suite, "vehicles") == 0) status |= bench_vehicles(argc, argv);
+    if (all || strcmp(suite, "collision") == 0) status |= bench_collision(argc, argv);
+    if (all || strcmp(suite, "profiler") == 0) status |= bench_profiler(argc, argv);
+    if (all || strcmp(suite, "world") == 0) status |= bench_world(argc, argv);
+    if (all || strcmp(suite, "pacing") == 0) status |= bench_pacing(argc, argv);
+    if (all || strcmp(suite, "audio") == 0) status |= bench_audio(argc, argv);
+    if (all || strcmp(suite, "jobs") == 0) status |= bench_jobs(argc, argv);
+    if (all || strcmp(suite, "net") == 0) status |= bench_net(argc, argv);
+    if (all || strcmp(suite, "ghosts") == 0) status |= bench_ghosts(argc, argv);
+    if (strcmp(suite, "replay") == 0) {
+        const char *path = NULL;
+        for (int i = 1; i < argc - 1; i++) {
+            if (strcmp(argv[i], "--replay") == 0) path = argv[i + 1];
+        }
+        if (!path) {
+            fprintf(stderr, "replay: needs --replay FILE\n");
+            return 1;
+        }
+        status |= replay_run(path);
+    }
+    jobs_shutdown();
+    return status;
+}
@@ -0,0 +1,357 @@
+#include "collision.h"
+#include "jobs.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846f
+#endif
+
+#define PAIR_BLOCK_PAIRS 256      // Pairs per scratch block in the parallel search
+#define SLICES_PER_THREAD 4       // Cell slices per thread, so a busy slice can be balanced
+#define SCAN_CELLS_PER_ENTRY 16   // Up to this many grid cells per occupied one, a scan beats a sort
+
+int collision_init(SpatialHash *hash, float world_width, float world_height, int cell_size, int body_capacity){
+    memset(hash, 0, sizeof *hash);
+    hash->cell_size = cell_size;
+    hash->cols = (int)ceilf(world_width / cell_size);
+    hash->rows = (int)ceilf(world_height / cell_size);
+    if (hash->cols < 1) hash->cols = 1;
+    if (hash->rows < 1) hash->rows = 1;
+    hash->body_capacity = body_capacity;
+
+    // Every body touches at least one cell, so this fits a tick without overlaps
+    hash->entry_capacity = body_capacity > 0 ? body_capacity : 1;
+    hash->cell_fill = calloc((size_t)hash->cols * hash->rows, sizeof(int));
+    hash->entries = malloc(sizeof(int) * (size_t)hash->entry_capacity);
+    hash->cells = malloc(sizeof(int) * (size_t)hash->entry_capacity);
+    hash->cell_start = malloc(sizeof(int) * ((size_t)hash->entry_capacity + 1));
+    float *bounds = malloc(sizeof(float) * 4 * (size_t)body_capacity);
+    if (!hash->cell_fill || !hash->entries || !hash->cells || !hash->cell_start || !bounds) {
+        free(bounds);
+        collision_free(hash);
+        return -1;
+    }
+    hash->min_x = bounds;
+    hash->min_y = bounds + body_capacity;
+    hash->max_x = bounds + 2 * (size_t)body_capacity;
+    hash->max_y = bounds + 3 * (size_t)body_capacity;
+    return 0;
+}
+
+void collision_free(SpatialHash *hash){
+    free(hash->cell_fill);
+    free(hash->cells);
+    free(hash->cell_start);
+    free(hash->entries);
+    free(hash->min_x);
+    free(hash->pairs);
+    memset(hash, 0, sizeof *hash);
+}
+
+static int clamp_cell(int cell, int count){
+    return cell < 0 ? 0 : cell >= count ? count - 1 : cell;
+}
+
+// Cell range a body covers, clamped to the grid; a body off the grid gets the nearest edge cells
+static void cell_span(const SpatialHash *hash, int body, int *x0, int *y0, int *x1, int *y1){
+    float inv = 1.0f / hash->cell_size;
+    *x0 = clamp_cell((int)(hash->min_x[body] * inv), hash->cols);
+    *y0 = clamp_cell((int)(hash->min_y[body] * inv), hash->rows);
+    *x1 = clamp_cell((int)(hash->max_x[body] * inv), hash->cols);
+    *y1 = clamp_cell((int)(hash->max_y[body] * inv), hash->rows);
+}
+
+// Puts the listed cells in row-major order: radix sort, a byte per pass, through `temp`
+static void sort_cells(int *cells, int *temp, int count, int grid_cells){
+    for (int shift = 0; (grid_cells - 1) >> shift > 0; shift += 8) {
+        int offsets[257] = {0};
+        for (int k = 0; k < count; k++) offsets[((cells[k] >> shift) & 255) + 1]++;
+        for (int d = 0; d < 256; d++) offsets[d + 1] += offsets[d];
+        for (int k = 0; k < count; k++) temp[offsets[(cells[k] >> shift) & 255]++] = cells[k];
+        memcpy(cells, temp, sizeof(int) * (size_t)count);
+    }
+}
+
+// Room for `total` entries (and as many occupied cells); grows the three arrays together
+static int reserve_entries(SpatialHash *hash, int total){
+    if (total <= hash->entry_capacity) return 0;
+    int *entries = realloc(hash->entries, sizeof(int) * (size_t)total);
+    if (entries) hash->entries = entries;
+    int *cells = entries ? realloc(hash->cells, sizeof(int) * (size_t)total) : NULL;
+    if (cells) hash->cells = cells;
+    int *start = cells ? realloc(hash->cell_start, sizeof(int) * ((size_t)total + 1)) : NULL;
+    if (!start) return -1;
+    hash->cell_start = start;
+    hash->entry_capacity = total;
+    return 0;
+}
+
+/**
+ * REBUILD BY COUNTING SORT
+ * ------------------------
+ * Every tick nearly every car moves, so instead of patching cell lists the grid is
+ * rebuilt from scratch in linear passes over the bodies:
+ *   1) count how many bodies touch each cell, listing each cell the first time
+ *   2) put the listed cells in row-major order and give each its start offset
+ *   3) write each body index into its cells' slots
+ * Only listed cells are written, and their counters are zeroed again at the end,
+ * so nothing scales with the grid. Ordering the list scans the counters while
+ * the grid is small next to the bodies (the game's 900 cells) and radix sorts the
+ * list once it is not (a --world-size map). Either way the cells come out in the same
+ * order as a full scan, so pairs do too. All storage is reused between ticks; it
+ * only grows when there are more entries than ever before.
+ */
+int collision_build(SpatialHash *hash, int count){
+    int *fill = hash->cell_fill;
+    hash->body_count = count;
+    hash->cell_count = 0;
+
+    for (;;) {
+        int total = 0;
+        for (int i = 0; i < count; i++) {
+            int x0, y0, x1, y1;
+            cell_span(hash, i, &x0, &y0, &x1, &y1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    int cell = y * hash->cols + x;
+                    if (fill[cell]++ == 0 && hash->cell_count < hash->entry_capacity) hash->cells[hash->cell_count++] = cell;
+                }
+            }
+            total += (x1 - x0 + 1) * (y1 - y0 + 1);
+        }
+        if (total <= hash->entry_capacity) break;
+        // More entries than ever before (the cell list may be cut short): zero the
+        // counters the slow way, grow and count again
+        for (int i = 0; i < count; i++) {
+            int x0, y0, x1, y1;
+            cell_span(hash, i, &x0, &y0, &x1, &y1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) fill[y * hash->cols + x] = 0;
+            }
+        }
+        hash->cell_count = 0;
+        if (reserve_entries(hash, total) != 0) return -1;
+    }
+
+    int grid_cells = hash->cols * hash->rows;
+    if (grid_cells <= hash->cell_count * SCAN_CELLS_PER_ENTRY) {
+        int listed = 0;
+        for (int cell = 0; cell < grid_cells; cell++) {
+            if (fill[cell]) hash->cells[listed++] = cell;
+        }
+    } else {
+        sort_cells(hash->cells, hash->cell_start, hash->cell_count, grid_cells);   // cell_start is free until below
+    }
+
+    // fill[cell] becomes the cell's write cursor, then goes back to zero
+    int offset = 0;
+    for (int k = 0; k < hash->cell_count; k++) {
+        int cell = hash->cells[k];
+        hash->cell_start[k] = offset;
+        offset += fill[cell];
+        fill[cell] = hash->cell_start[k];
+    }
+    hash->cell_start[hash->cell_count] = offset;
+    for (int i = 0; i < count; i++) {
+        int x0, y0, x1, y1;
+        cell_span(hash, i, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) hash->entries[fill[y * hash->cols + x]++] = i;
+        }
+    }
+    for (int k = 0; k < hash->cell_count; k++) fill[hash->cells[k]] = 0;
+    return 0;
+}
+
+// Makes room for at least `count` pairs
+static int reserve_pairs(SpatialHash *hash, int count){
+    if (count <= hash->pair_capacity) return 0;
+    int capacity = hash->pair_capacity ? hash->pair_capacity : 256;
+    while (capacity < count) capacity *= 2;
+    BodyPair *pairs = realloc(hash->pairs, sizeof(BodyPair) * (size_t)capacity);
+    if (!pairs) return -1;
+    hash->pairs = pairs;
+    hash->pair_capacity = capacity;
+    return 0;
+}
+
+static int push_pair(SpatialHash *hash, int a, int b){
+    if (reserve_pairs(hash, hash->pair_count + 1) != 0) return -1;
+    hash->pairs[hash->pair_count++] = (BodyPair){a < b ? a : b, a < b ? b : a};
+    return 0;
+}
+
+static int bounds_overlap(const SpatialHash *hash, int a, int b){
+    return hash->min_x[a] <= hash->max_x[b] && hash->max_x[a] >= hash->min_x[b] &&
+           hash->min_y[a] <= hash->max_y[b] && hash->max_y[a] >= hash->min_y[b];
+}
+
+// Bodies a and b both sit in cell (cx, cy): do they overlap, and is this the cell that reports them?
+static int cell_owns_pair(const SpatialHash *hash, float inv, int a, int b, int cx, int cy){
+    if (!bounds_overlap(hash, a, b)) return 0;
+    int owner_x = (int)(fmaxf(hash->min_x[a], hash->min_x[b]) * inv);
+    int owner_y = (int)(fmaxf(hash->min_y[a], hash->min_y[b]) * inv);
+    return clamp_cell(owner_x, hash->cols) == cx && clamp_cell(owner_y, hash->rows) == cy;
+}
+
+/**
+ * ONE REPORT PER PAIR
+ * -------------------
+ * Two bodies that straddle cell borders can share up to four cells. The pair is
+ * only reported from the cell that holds the top-left corner of the overlap of
+ * their bounds — exactly one cell both of them touch — so no dedup set is needed.
+ */
+int collision_find_pairs(SpatialHash *hash){
+    hash->pair_count = 0;
+    float inv = 1.0f / hash->cell_size;
+    for (int k = 0; k < hash->cell_count; k++) {
+        int cx = hash->cells[k] % hash->cols, cy = hash->cells[k] / hash->cols;
+        int first = hash->cell_start[k], last = hash->cell_start[k + 1];
+        for (int i = first; i < last; i++) {
+            int a = hash->entries[i];
+            for (int j = i + 1; j < last; j++) {
+                int b = hash->entries[j];
+                if (cell_owns_pair(hash, inv, a, b, cx, cy) && push_pair(hash, a, b) != 0) return -1;
+            }
+        }
+    }
+    return hash->pair_count;
+}
+
+// ----------------------------
+// PARALLEL PAIR SEARCH
+// ----------------------------
+typedef struct PairBlock {
+    struct PairBlock *next;
+    int count;
+    BodyPair pairs[PAIR_BLOCK_PAIRS];
+} PairBlock;
+
+typedef struct {
+    SpatialHash *hash;
+    Arena *scratch;
+    int cells_per_slice;
+    PairBlock **slices;   // First block of each slice's pairs
+    int failed;           // A slice ran out of scratch memory
+} PairSearch;
+
+// One slice of occupied cells; its pairs go into a chain of scratch blocks
+static void find_pairs_job(void *data, int begin, int end){
+    PairSearch *search = data;
+    const SpatialHash *hash = search->hash;
+    float inv = 1.0f / hash->cell_size;
+    PairBlock *first = NULL, *block = NULL;
+    for (int k = begin; k < end; k++) {
+        int cx = hash->cells[k] % hash->cols, cy = hash->cells[k] / hash->cols;
+        int first_entry = hash->cell_start[k], last_entry = hash->cell_start[k + 1];
+        for (int i = first_entry; i < last_entry; i++) {
+            int a = hash->entries[i];
+            for (int j = i + 1; j < last_entry; j++) {
+                int b = hash->entries[j];
+                if (!cell_owns_pair(hash, inv, a, b, cx, cy)) continue;
+                if (!block || block->count == PAIR_BLOCK_PAIRS) {
+                    PairBlock *next = arena_alloc(search->scratch, sizeof *next);
+                    if (!next) {
+                        __atomic_store_n(&search->failed, 1, __ATOMIC_RELAXED);
+                        return;
+                    }
+                    next->next = NULL;
+                    next->count = 0;
+                    if (block) block->next = next;
+                    else first = next;
+                    block = next;
+                }
+                block->pairs[block->count++] = (BodyPair){a < b ? a : b, a < b ? b : a};
+            }
+        }
+    }
+    search->slices[begin / search->cells_per_slice] = first;
+}
+
+/**
+ * SAME ORDER AS THE SERIAL SEARCH
+ * -------------------------------
+ * Each job scans a run of the occupied cells, which only reads the hash, and keeps
+ * its pairs in blocks from the frame arena. The runs are then joined in order,
+ * which is exactly the order the serial loop reports pairs in. Collision response
+ * depends on that order, so the simulation comes out bit-identical with any
+ * number of threads. If the arena runs out, the serial search is used instead
+ * (the arena grows on its next reset), and so it is below `min_bodies`: a game's
+ * few hundred bodies search faster on one thread than split into jobs.
+ */
+int collision_find_pairs_parallel(SpatialHash *hash, Arena *scratch, int min_bodies){
+    int threads = jobs_thread_count();
+    if (threads == 1 || hash->cell_count < 2 || hash->body_count < min_bodies) return collision_find_pairs(hash);
+    int slice_count = threads * SLICES_PER_THREAD;
+    if (slice_count > hash->cell_count) slice_count = hash->cell_count;
+    int cells_per_slice = (hash->cell_count + slice_count - 1) / slice_count;
+    slice_count = (hash->cell_count + cells_per_slice - 1) / cells_per_slice;
+
+    PairSearch search = {hash, scratch, cells_per_slice, arena_alloc(scratch, sizeof(PairBlock *) * slice_count), 0};
+    if (!search.slices) return collision_find_pairs(hash);
+    memset(search.slices, 0, sizeof(PairBlock *) * slice_count);
+    parallel_for(0, hash->cell_count, cells_per_slice, find_pairs_job, &search);
+    if (search.failed) return collision_find_pairs(hash);
+
+    int total = 0;
+    for (int s = 0; s < slice_count; s++) {
+        for (PairBlock *block = search.slices[s]; block; block = block->next) total += block->count;
+    }
+    if (reserve_pairs(hash, total) != 0) return -1;
+    hash->pair_count = 0;
+    for (int s = 0; s < slice_count; s++) {
+        for (PairBlock *block = search.slices[s]; block; block = block->next) {
+            memcpy(hash->pairs + hash->pair_count, block->pairs, sizeof(BodyPair) * block->count);
+            hash->pair_count += block->count;
+        }
+    }
+    return hash->pair_count;
+}
+
+int collision_find_pairs_brute(SpatialHash *hash){
+    hash->pair_count = 0;
+    for (int a = 0; a < hash->body_count; a++) {
+        for (int b = a + 1; b < hash->body_count; b++) {
+            if (bounds_overlap(hash, a, b) && push_pair(hash, a, b) != 0) return -1;
+        }
+    }
+    return hash->pair_count;
+}
+
+// Half-length of `box` projected on the unit axis (ax, ay)
+static float project(Obb box, float ux, float uy, float vx, float vy, float ax, float ay){
+    return box.half_width * fabsf(ux * ax + uy * ay) + box.half_height * fabsf(vx * ax + vy * ay);
+}
+
+/**
+ * SEPARATING AXIS TEST
+ * --------------------
+ * Two convex shapes don't touch if there is an axis on which their projections
+ * don't overlap. For two rectangles only their four edge normals need checking.
+ * The axis with the smallest overlap is the shortest way to push them apart.
+ */
+int collision_obb_overlap(Obb a, Obb b, float *push_x, float *push_y){
+    float ra = a.rotation * PI / 180.0f, rb = b.rotation * PI / 180.0f;
+    float aux = cosf(ra), auy = sinf(ra), avx = -auy, avy = aux;
+    float bux = cosf(rb), buy = sinf(rb), bvx = -buy, bvy = bux;
+    float axes[4][2] = {{aux, auy}, {avx, avy}, {bux, buy}, {bvx, bvy}};
+    float dx = a.x - b.x, dy = a.y - b.y;
+
+    float best = INFINITY, best_x = 0, best_y = 0;
+    for (int i = 0; i < 4; i++) {
+        float ax = axes[i][0], ay = axes[i][1];
+        float distance = dx * ax + dy * ay;
+        float overlap = project(a, aux, auy, avx, avy, ax, ay) + project(b, bux, buy, bvx, bvy, ax, ay) - fabsf(distance);
+        if (overlap <= 0) return 0;
+        if (overlap < best) {
+            best = overlap;
+            best_x = distance < 0 ? -ax : ax;
+            best_y = distance < 0 ? -ay : ay;
+        }
+    }
+    *push_x = best_x * best;
+    *push_y = best_y * best;
+    return 1;
+}
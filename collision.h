@@ -0,0 +1,72 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "arena.h"
+
+// ----------------------------
+// COLLISION (spatial-hash broadphase + OBB narrowphase)
+// ----------------------------
+// Bodies are dropped into a uniform grid whose cells are the 512px ground tiles.
+// Only bodies that share a cell are tested against each other, so the cost grows
+// with the number of bodies instead of the number of pairs. Only the cells bodies
+// touch are cleared and visited, so a bigger world costs memory (one counter per
+// cell) but no time per tick. Candidate pairs are then checked exactly as rotated
+// rectangles (separating axis test).
+
+#define COLLISION_CELL_SIZE 512   // Same grid as the ground tiles
+
+typedef struct {
+    int a, b;                     // Body indices, a < b
+} BodyPair;
+
+typedef struct {
+    // Grid covering [0, cols * cell_size) × [0, rows * cell_size)
+    int cell_size;
+    int cols, rows;
+    int *cell_fill;               // cols * rows body counts, all zero between builds
+    int *cells;                   // Occupied cells (y * cols + x), in row-major order
+    int *cell_start;              // cell_count + 1 offsets into `entries`
+    int cell_count;
+    int *entries;                 // Body indices sorted by cell
+    int entry_capacity;           // Of `entries`, `cells` and (+ 1) `cell_start`
+
+    // Axis-aligned bounds of each body, filled in by the caller before building
+    float *min_x, *min_y, *max_x, *max_y;
+    int body_count, body_capacity;
+
+    // Output of collision_find_pairs
+    BodyPair *pairs;
+    int pair_count, pair_capacity;
+} SpatialHash;
+
+// Rotated rectangle: centre, half size and rotation in degrees
+typedef struct {
+    float x, y;
+    float half_width, half_height;
+    float rotation;
+} Obb;
+
+// Sizes the grid for a world_width × world_height world; returns 0 or -1 if out of memory
+int collision_init(SpatialHash *hash, float world_width, float world_height, int cell_size, int body_capacity);
+
+// Frees everything the hash allocated
+void collision_free(SpatialHash *hash);
+
+// Re-sorts the first `count` bodies into cells (counting sort over the occupied cells)
+int collision_build(SpatialHash *hash, int count);
+
+// Fills hash->pairs with every pair of bodies whose bounds overlap, each pair once
+int collision_find_pairs(SpatialHash *hash);
+
+// Same pairs in the same order, with runs of occupied cells searched on the job system;
+// the pair lists are built in `scratch`. Fewer than `min_bodies` bodies are searched serially
+int collision_find_pairs_parallel(SpatialHash *hash, Arena *scratch, int min_bodies);
+
+// Reference O(n²) version of collision_find_pairs, for benchmarks and checks
+int collision_find_pairs_brute(SpatialHash *hash);
+
+// Separating axis test. On overlap returns 1 and the shortest push (push_x, push_y)
+// that moves `a` out of `b`; returns 0 otherwise.
+int collision_obb_overlap(Obb a, Obb b, float *push_x, float *push_y);
+
+#endif
@@ -0,0 +1,52 @@
+#include "config.h"
+#include "app.h"
+#include "pacing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void config_default(GameConfig *config){
+    config->pacing_mode = PACING_HYBRID;
+    config->target_fps = 60;
+    config->sound_volume = APP_SOUND_STEPS;
+}
+
+int config_load(GameConfig *config, const char *path){
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+    char line[128];
+    while (fgets(line, sizeof line, file)) {
+        char *value = strchr(line, '=');
+        if (!value) continue;
+        *value++ = '\0';
+        value[strcspn(value, "\r\n")] = '\0';
+        if (strcmp(line, "pacing") == 0) {
+            for (int i = 0; i < PACING_MODE_COUNT; i++) {
+                if (strcmp(value, pacing_mode_names[i]) == 0) config->pacing_mode = i;
+            }
+        } else if (strcmp(line, "target_fps") == 0) {
+            int fps = atoi(value);
+            if (fps > 0) config->target_fps = pacing_valid_target(fps);
+        } else if (strcmp(line, "sound_volume") == 0) {
+            int volume = atoi(value);
+            if (volume >= 0 && volume <= APP_SOUND_STEPS) config->sound_volume = volume;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+int config_save(const GameConfig *config, const char *path){
+    char temp_path[256];
+    snprintf(temp_path, sizeof temp_path, "%s.tmp", path);
+    FILE *file = fopen(temp_path, "w");
+    if (!file) return -1;
+    fprintf(file, "pacing=%s\n", pacing_mode_names[config->pacing_mode]);
+    fprintf(file, "target_fps=%d\n", config->target_fps);
+    fprintf(file, "sound_volume=%d\n", config->sound_volume);
+    if (fclose(file) != 0 || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        return -1;
+    }
+    return 0;
+}
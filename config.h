@@ -0,0 +1,28 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// ----------------------------
+// SETTINGS FILE
+// ----------------------------
+// Choices made in the settings screen survive a restart in a small text file of
+// `key=value` lines next to the game. Unknown keys and bad values are ignored, so
+// an old or hand-edited file never stops the game from starting.
+
+#define CONFIG_PATH "raceee.cfg"
+
+typedef struct {
+    int pacing_mode;   // PacingMode
+    int target_fps;
+    int sound_volume;  // Tenths, 0 .. APP_SOUND_STEPS
+} GameConfig;
+
+// Defaults (hybrid pacing at 60 FPS, full sound volume)
+void config_default(GameConfig *config);
+
+// Reads PATH over the current values; returns 0 if the file was read
+int config_load(GameConfig *config, const char *path);
+
+// Writes PATH (via a temporary file); returns 0 on success
+int config_save(const GameConfig *config, const char *path);
+
+#endif
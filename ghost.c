@@ -0,0 +1,474 @@
+#define _POSIX_C_SOURCE 200112L
+#include "ghost.h"
+#include "sim.h"
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define PI 3.14159265358979323846f
+#define POSITION_UNIT 4              // Knot positions are in 1/4 px
+#define TURN 2048                    // Knot facings are in 1/2048 turn
+#define SPEED_UNIT 32                // Knot speeds are in 1/32 px per tick
+#define SINE_ONE 16384               // fixed_sin() returns sines in 1/16384
+#define CODE_ORDER 4                 // Exp-Golomb order of every knot field: up to 15 takes 5 bits
+
+typedef struct {
+    int magic, version;
+    int world_width, world_height;
+    long long ticks;
+    int key_count;
+    unsigned int data_size;
+} GhostHeader;
+
+static int wrap_turn(int delta){
+    delta &= TURN - 1;
+    return delta >= TURN / 2 ? delta - TURN : delta;
+}
+
+// Bhaskara's sine in integers (within 0.2%), so every machine decodes a ghost the same
+static int fixed_sin(int angle){
+    int a = angle & (TURN / 2 - 1);
+    long long p = (long long)a * (TURN / 2 - a);
+    int sine = (int)(4 * p * SINE_ONE / (5LL * TURN * TURN / 16 - p));
+    return angle & TURN / 2 ? -sine : sine;
+}
+
+static int fixed_cos(int angle){
+    return fixed_sin(angle + TURN / 4);
+}
+
+static GhostKnot make_knot(long tick, float x, float y, float rotation, float speed){
+    return (GhostKnot){(int)tick, (int)lroundf(x * POSITION_UNIT), (int)lroundf(y * POSITION_UNIT),
+                       (int)lroundf(rotation * (TURN / 360.0f)) & (TURN - 1), (int)lroundf(speed * SPEED_UNIT)};
+}
+
+/**
+ * ONE POINT ON THE CURVE
+ * ----------------------
+ * The only place a pose is made: playback calls it for every tick it shows,
+ * the recorder for every tick it checks, so what was checked is what is seen.
+ * `tick` may fall between ticks and is clamped to the segment. No libm: the
+ * same knots give the same poses on every machine.
+ */
+static GhostPose segment_pose(const GhostKnot *a, const GhostKnot *b, float tick){
+    float span = (float)(b->tick - a->tick);
+    float u = span > 0 ? (tick - a->tick) / span : 0;
+    u = u < 0 ? 0 : u > 1 ? 1 : u;
+    float u2 = u * u, u3 = u2 * u;
+    float h00 = 2 * u3 - 3 * u2 + 1, h10 = u3 - 2 * u2 + u, h01 = 3 * u2 - 2 * u3, h11 = u3 - u2;
+    // Tangents: each knot's velocity over the whole segment
+    float m0 = h10 * a->speed * span / ((float)SPEED_UNIT * SINE_ONE);
+    float m1 = h11 * b->speed * span / ((float)SPEED_UNIT * SINE_ONE);
+    GhostPose pose;
+    pose.x = (h00 * a->x + h01 * b->x) / POSITION_UNIT + m0 * fixed_cos(a->rotation) + m1 * fixed_cos(b->rotation);
+    pose.y = (h00 * a->y + h01 * b->y) / POSITION_UNIT + m0 * fixed_sin(a->rotation) + m1 * fixed_sin(b->rotation);
+    float rotation = (a->rotation + wrap_turn(b->rotation - a->rotation) * u) * (360.0f / TURN);
+    pose.rotation = rotation < 0 ? rotation + 360 : rotation >= 360 ? rotation - 360 : rotation;
+    return pose;
+}
+
+/**
+ * PREDICTING A KNOT
+ * -----------------
+ * A knot's position is stored as its offset from where the car would be had it
+ * gone from `prev` at the mean of the two speeds along the mean of the two
+ * facings: exact on a straight or a speed-up, close on a steady turn, so most
+ * offsets are a few eighths of a pixel. Integers only, so the prediction and
+ * with it every later knot comes out the same on every machine.
+ */
+static void predict_position(const GhostKnot *prev, const GhostKnot *knot, int *x, int *y){
+    int heading = prev->rotation + wrap_turn(knot->rotation - prev->rotation) / 2;
+    long long distance = (long long)(knot->tick - prev->tick) * (prev->speed + knot->speed) * POSITION_UNIT;
+    *x = prev->x + (int)(distance * fixed_cos(heading) / (2LL * SPEED_UNIT * SINE_ONE));
+    *y = prev->y + (int)(distance * fixed_sin(heading) / (2LL * SPEED_UNIT * SINE_ONE));
+}
+
+// ----------------------------
+// RECORDING
+// ----------------------------
+static int reserve(Ghost *ghost, size_t extra){
+    if (ghost->size + extra <= ghost->capacity) return 0;
+    size_t capacity = ghost->capacity ? ghost->capacity * 2 : 256;
+    while (capacity < ghost->size + extra) capacity *= 2;
+    unsigned char *data = realloc(ghost->data, capacity);
+    if (!data) return -1;
+    ghost->data = data;
+    ghost->capacity = capacity;
+    return 0;
+}
+
+static void put_bit(Ghost *ghost, unsigned int bit){
+    size_t byte = ghost->bits >> 3;
+    if ((ghost->bits & 7) == 0) ghost->data[ghost->size++] = 0;
+    ghost->data[byte] |= (unsigned char)(bit << (ghost->bits & 7));
+    ghost->bits++;
+}
+
+// Exp-Golomb code: small values in few bits, any value in at most 64
+static void put_code(Ghost *ghost, unsigned int value){
+    unsigned long long coded = (unsigned long long)value + (1ull << CODE_ORDER);
+    int length = 0;
+    while (coded >> length > 1) length++;
+    for (int i = CODE_ORDER; i < length; i++) put_bit(ghost, 0);
+    for (int i = length; i >= 0; i--) put_bit(ghost, (unsigned int)(coded >> i) & 1);
+}
+
+static void put_signed(Ghost *ghost, int value){
+    put_code(ghost, ((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+}
+
+static int add_keyframe(Ghost *ghost, const GhostKnot *knot){
+    if (ghost->key_count == ghost->key_capacity) {
+        int capacity = ghost->key_capacity ? ghost->key_capacity * 2 : 16;
+        GhostKeyframe *keys = realloc(ghost->keys, sizeof *keys * capacity);
+        if (!keys) return -1;
+        ghost->keys = keys;
+        ghost->key_capacity = capacity;
+    }
+    ghost->keys[ghost->key_count++] = (GhostKeyframe){*knot, (unsigned int)ghost->bits};
+    return 0;
+}
+
+// Appends `knot` after `prev`; every keyframe boundary in between is indexed to `prev` first
+static int write_knot(Ghost *ghost, const GhostKnot *prev, const GhostKnot *knot){
+    while ((long)ghost->key_count * GHOST_KEYFRAME_TICKS < knot->tick) {
+        if (add_keyframe(ghost, prev) != 0) return -1;
+    }
+    if (reserve(ghost, 5 * 9) != 0) return -1;   // Five codes of at most 66 bits
+    int x, y;
+    predict_position(prev, knot, &x, &y);
+    put_code(ghost, (unsigned int)(knot->tick - prev->tick - 1));
+    put_signed(ghost, wrap_turn(knot->rotation - prev->rotation));
+    put_signed(ghost, knot->speed - prev->speed);
+    put_signed(ghost, knot->x - x);
+    put_signed(ghost, knot->y - y);
+    return 0;
+}
+
+void ghost_begin(Ghost *ghost, int world_width, int world_height){
+    memset(ghost, 0, sizeof *ghost);
+    ghost->world_width = world_width;
+    ghost->world_height = world_height;
+}
+
+// Whether every tick held since the anchor, up to `end`, lies close enough to the curve from it to `to`
+static int segment_fits(const Ghost *ghost, const GhostKnot *to, long end){
+    const float tolerance = GHOST_POSITION_TOLERANCE * GHOST_POSITION_TOLERANCE;
+    for (long i = 1; i < end; i++) {
+        const float *sample = &ghost->samples[3 * i];
+        GhostPose pose = segment_pose(&ghost->anchor, to, (float)(ghost->anchor.tick + i));
+        float dx = pose.x - sample[0], dy = pose.y - sample[1];
+        float turn = fabsf(fmodf(pose.rotation - sample[2] + 540, 360) - 180);
+        if (dx * dx + dy * dy > tolerance || turn > GHOST_ROTATION_TOLERANCE) return 0;
+    }
+    return 1;
+}
+
+/**
+ * PLACING KNOTS
+ * -------------
+ * Each tick becomes a candidate knot, its speed taken from how far the car
+ * moved along its facing since the last tick. If the curve from the anchor
+ * (the last knot written) to the candidate still passes every tick held since
+ * the anchor, the candidate replaces the previous one; if not, the previous
+ * candidate, which did pass them, is written and becomes the anchor. The
+ * first knot only goes in the index, its speed taken on the second tick.
+ */
+int ghost_record(Ghost *ghost, float x, float y, float rotation){
+    if (!ghost->samples) {
+        ghost->samples = malloc(sizeof *ghost->samples * 3 * (GHOST_MAX_SEGMENT_TICKS + 1));
+        if (!ghost->samples) return -1;
+    }
+    long index = 0;
+    if (ghost->ticks == 0) {
+        ghost->anchor = make_knot(0, x, y, rotation, 0);
+    } else {
+        float angle = rotation * (PI / 180);
+        float along = (x - ghost->last_x) * cosf(angle) + (y - ghost->last_y) * sinf(angle);
+        GhostKnot knot = make_knot(ghost->ticks, x, y, rotation, along);
+        index = ghost->ticks - ghost->anchor.tick;
+        if (ghost->ticks == 1) {
+            ghost->anchor.speed = knot.speed;
+        } else if (index > GHOST_MAX_SEGMENT_TICKS || !segment_fits(ghost, &knot, index)) {
+            if (write_knot(ghost, &ghost->anchor, &ghost->candidate) != 0) return -1;
+            ghost->anchor = ghost->candidate;
+            memcpy(ghost->samples, &ghost->samples[3 * (index - 1)], sizeof *ghost->samples * 3);
+            index = 1;
+        }
+        ghost->candidate = knot;
+    }
+    float *sample = &ghost->samples[3 * index];
+    sample[0] = x;
+    sample[1] = y;
+    sample[2] = rotation;
+    ghost->last_x = x;
+    ghost->last_y = y;
+    ghost->ticks++;
+    return 0;
+}
+
+void ghost_finish(Ghost *ghost){
+    free(ghost->samples);
+    ghost->samples = NULL;
+    if (ghost->ticks == 0) return;
+    if (ghost->ticks > 1 && write_knot(ghost, &ghost->anchor, &ghost->candidate) == 0) ghost->anchor = ghost->candidate;
+    // Every boundary up to the last tick gets an entry, as ghost_load() expects
+    while ((long)ghost->key_count * GHOST_KEYFRAME_TICKS <= ghost->ticks - 1) {
+        if (add_keyframe(ghost, &ghost->anchor) != 0) break;
+    }
+    // Trim the growth slack: a loaded set of ghosts holds exactly what it uses
+    if (ghost->size > 0 && ghost->size < ghost->capacity) {
+        unsigned char *data = realloc(ghost->data, ghost->size);
+        if (data) {
+            ghost->data = data;
+            ghost->capacity = ghost->size;
+        }
+    }
+    if (ghost->key_count > 0 && ghost->key_count < ghost->key_capacity) {
+        GhostKeyframe *keys = realloc(ghost->keys, sizeof *keys * ghost->key_count);
+        if (keys) {
+            ghost->keys = keys;
+            ghost->key_capacity = ghost->key_count;
+        }
+    }
+}
+
+void ghost_free(Ghost *ghost){
+    free(ghost->data);
+    free(ghost->keys);
+    free(ghost->samples);
+    memset(ghost, 0, sizeof *ghost);
+}
+
+size_t ghost_memory(const Ghost *ghost){
+    return ghost->capacity + sizeof(GhostKeyframe) * ghost->key_capacity;
+}
+
+// ----------------------------
+// PLAYBACK
+// ----------------------------
+static unsigned int get_bit(const Ghost *ghost, size_t *offset){
+    size_t bit = (*offset)++;
+    return bit < ghost->size * 8 ? ghost->data[bit >> 3] >> (bit & 7) & 1 : 1;   // Past the end: stop codes
+}
+
+static unsigned int get_code(const Ghost *ghost, size_t *offset){
+    int length = CODE_ORDER;
+    while (length < 32 && !get_bit(ghost, offset)) length++;
+    unsigned long long coded = 1;
+    for (int i = 0; i < length; i++) coded = coded << 1 | get_bit(ghost, offset);
+    return (unsigned int)(coded - (1ull << CODE_ORDER));
+}
+
+static int get_signed(const Ghost *ghost, size_t *offset){
+    unsigned int value = get_code(ghost, offset);
+    return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+// Moves the cursor one knot on; at the last knot (on the last tick) it stays put
+static void cursor_step(const Ghost *ghost, GhostCursor *cursor){
+    if (cursor->to.tick >= ghost->ticks - 1) return;
+    GhostKnot from = cursor->to, to;
+    to.tick = from.tick + 1 + (int)get_code(ghost, &cursor->offset);
+    to.rotation = (from.rotation + get_signed(ghost, &cursor->offset)) & (TURN - 1);
+    to.speed = from.speed + get_signed(ghost, &cursor->offset);
+    predict_position(&from, &to, &to.x, &to.y);
+    to.x += get_signed(ghost, &cursor->offset);
+    to.y += get_signed(ghost, &cursor->offset);
+    cursor->from = from;
+    cursor->to = to;
+}
+
+static long clamp_tick(const Ghost *ghost, long tick){
+    if (tick >= ghost->ticks) tick = ghost->ticks - 1;
+    return tick < 0 ? 0 : tick;
+}
+
+static void cursor_follow(const Ghost *ghost, GhostCursor *cursor, long tick){
+    while (cursor->to.tick < tick) cursor_step(ghost, cursor);
+    cursor->tick = tick;
+}
+
+void ghost_seek(const Ghost *ghost, GhostCursor *cursor, long tick){
+    memset(cursor, 0, sizeof *cursor);
+    cursor->tick = -1;
+    if (ghost->key_count == 0) return;
+    tick = clamp_tick(ghost, tick);
+    // The segment has to reach back to the tick before, so blending works straight away
+    long from = tick > 0 ? tick - 1 : 0;
+    int key = (int)(from / GHOST_KEYFRAME_TICKS);
+    if (key >= ghost->key_count) key = ghost->key_count - 1;
+    cursor->from = cursor->to = ghost->keys[key].knot;
+    cursor->offset = ghost->keys[key].offset;
+    cursor_step(ghost, cursor);
+    cursor_follow(ghost, cursor, tick);
+}
+
+void ghost_advance(const Ghost *ghost, GhostCursor *cursor, long tick){
+    tick = clamp_tick(ghost, tick);
+    if (cursor->tick < 0 || tick < cursor->tick || tick - cursor->tick > GHOST_KEYFRAME_TICKS) {
+        ghost_seek(ghost, cursor, tick);
+        return;
+    }
+    cursor_follow(ghost, cursor, tick);
+}
+
+GhostPose ghost_pose(const GhostCursor *cursor, float alpha){
+    return segment_pose(&cursor->from, &cursor->to, cursor->tick - 1 + alpha);
+}
+
+// ----------------------------
+// FILES
+// ----------------------------
+int ghost_save(const Ghost *ghost, const char *path){
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "ghost: could not write %s\n", path);
+        return -1;
+    }
+    GhostHeader header = {GHOST_MAGIC, GHOST_VERSION, ghost->world_width, ghost->world_height,
+                          ghost->ticks, ghost->key_count, (unsigned int)ghost->size};
+    int ok = fwrite(&header, sizeof header, 1, file) == 1 &&
+             fwrite(ghost->keys, sizeof *ghost->keys, ghost->key_count, file) == (size_t)ghost->key_count &&
+             fwrite(ghost->data, 1, ghost->size, file) == ghost->size;
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "ghost: could not write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int read_header(FILE *file, GhostHeader *header){
+    return fread(header, sizeof *header, 1, file) == 1 && header->magic == GHOST_MAGIC &&
+           header->version == GHOST_VERSION && header->ticks > 0 && header->key_count > 0 &&
+           header->key_count == (header->ticks - 1) / GHOST_KEYFRAME_TICKS + 1;
+}
+
+int ghost_load(Ghost *ghost, const char *path){
+    memset(ghost, 0, sizeof *ghost);
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "ghost: could not open %s\n", path);
+        return -1;
+    }
+    GhostHeader header;
+    int ok = read_header(file, &header);
+    if (ok) {
+        ghost->keys = malloc(sizeof *ghost->keys * header.key_count);
+        ghost->data = malloc(header.data_size ? header.data_size : 1);
+        ok = ghost->keys && ghost->data &&
+             fread(ghost->keys, sizeof *ghost->keys, header.key_count, file) == (size_t)header.key_count &&
+             fread(ghost->data, 1, header.data_size, file) == header.data_size;
+    }
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "ghost: %s is not a ghost file\n", path);
+        ghost_free(ghost);
+        return -1;
+    }
+    ghost->ticks = (long)header.ticks;
+    ghost->size = ghost->capacity = header.data_size;
+    ghost->key_count = ghost->key_capacity = header.key_count;
+    ghost->world_width = header.world_width;
+    ghost->world_height = header.world_height;
+    for (int i = 0; i < ghost->key_count; i++) {
+        if (ghost->keys[i].offset > ghost->size * 8) ghost->keys[i].offset = (unsigned int)ghost->size * 8;
+    }
+    return 0;
+}
+
+typedef struct {
+    long long ticks;
+    char path[512];
+} GhostEntry;
+
+static int compare_entries(const void *a, const void *b){
+    long long x = ((const GhostEntry *)a)->ticks, y = ((const GhostEntry *)b)->ticks;
+    return (x > y) - (x < y);
+}
+
+/**
+ * PICKING GHOSTS
+ * --------------
+ * Only the headers are read while scanning the folder, so a folder with
+ * hundreds of laps costs a directory listing; then the `max` fastest laps on
+ * this course are loaded in full.
+ */
+int ghost_load_dir(Ghost *ghosts, int max, const char *dir, int world_width, int world_height){
+    DIR *folder = opendir(dir);
+    if (!folder) return 0;   // No laps saved yet
+    GhostEntry *entries = NULL;
+    int count = 0, capacity = 0;
+    struct dirent *item;
+    while ((item = readdir(folder))) {
+        size_t length = strlen(item->d_name);
+        if (length < 4 || strcmp(item->d_name + length - 4, ".rgh") != 0) continue;
+        GhostEntry entry;
+        snprintf(entry.path, sizeof entry.path, "%s/%s", dir, item->d_name);
+        FILE *file = fopen(entry.path, "rb");
+        if (!file) continue;
+        GhostHeader header;
+        int usable = read_header(file, &header) && header.world_width == world_width && header.world_height == world_height;
+        fclose(file);
+        if (!usable) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            GhostEntry *grown = realloc(entries, sizeof *entries * capacity);
+            if (!grown) break;
+            entries = grown;
+        }
+        entry.ticks = header.ticks;
+        entries[count++] = entry;
+    }
+    closedir(folder);
+
+    qsort(entries, count, sizeof *entries, compare_entries);
+    int loaded = 0;
+    for (int i = 0; i < count && loaded < max; i++) {
+        if (ghost_load(&ghosts[loaded], entries[i].path) == 0) loaded++;
+    }
+    free(entries);
+    return loaded;
+}
+
+int ghost_save_lap(const Ghost *ghost, const char *dir){
+    mkdir(dir, 0755);   // Fails harmlessly if it exists; a real problem shows up in fopen
+    char path[512];
+    snprintf(path, sizeof path, "%s/lap_%08ld_%ld.rgh", dir, ghost->ticks * 1000 / SIM_TICK_RATE, (long)time(NULL));
+    return ghost_save(ghost, path);
+}
+
+int ghost_keep(Ghost *ghosts, int count, int max, Ghost *lap){
+    int at = count;
+    while (at > 0 && ghosts[at - 1].ticks > lap->ticks) at--;
+    if (at == max) {   // Slower than every kept lap
+        ghost_free(lap);
+        return count;
+    }
+    if (count == max) ghost_free(&ghosts[--count]);
+    memmove(&ghosts[at + 1], &ghosts[at], sizeof *ghosts * (count - at));
+    ghosts[at] = *lap;
+    memset(lap, 0, sizeof *lap);
+    return count + 1;
+}
+
+// ----------------------------
+// BATCHED QUADS
+// ----------------------------
+// Same corners DrawTexturePro() would compute for a sprite rotated about its centre
+void ghost_build_quads(const GhostPose *poses, int count, float car_width, float car_height, GhostQuad *quads){
+    const float local_x[4] = {-car_width / 2, -car_width / 2, car_width / 2, car_width / 2};
+    const float local_y[4] = {-car_height / 2, car_height / 2, car_height / 2, -car_height / 2};
+    for (int i = 0; i < count; i++) {
+        float angle = poses[i].rotation * (PI / 180);
+        float c = cosf(angle), s = sinf(angle);
+        for (int k = 0; k < 4; k++) {
+            quads[i].x[k] = poses[i].x + local_x[k] * c - local_y[k] * s;
+            quads[i].y[k] = poses[i].y + local_x[k] * s + local_y[k] * c;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef GHOST_H
+#define GHOST_H
+
+#include <stddef.h>
+
+// ----------------------------
+// GHOST TRAJECTORIES
+// ----------------------------
+// The path of a car over one lap (x, y and facing every tick), stored compactly
+// enough that ten minutes of driving take about 10 KB and dozens of ghosts can be kept,
+// loaded and scrubbed at once. Raylib-free; ghost_draw.c puts them on screen.
+
+#define GHOST_MAGIC 0x31484752        // "RGH1"
+#define GHOST_VERSION 3
+#define GHOST_KEYFRAME_TICKS 3600     // One index entry every 30 s of driving
+#define GHOST_MAX_SEGMENT_TICKS 480   // At most 4 s between knots, which bounds the recording work per tick
+#define GHOST_POSITION_TOLERANCE 1.0f // Pixels a decoded tick may be off the recorded one
+#define GHOST_ROTATION_TOLERANCE 0.5f // ... and degrees of facing
+#define GHOST_DIR "ghosts"            // Completed laps are saved here and loaded at startup
+
+/**
+ * ENCODING
+ * --------
+ * A ghost only has to look right, so it is lossy: the stream holds knots (tick,
+ * position, facing and speed along the facing) and playback joins them with a
+ * cubic Hermite curve whose end tangents are the knots' velocities, turning
+ * the facing evenly in between. A steady turn, a straight or a speed-up is one
+ * curve; the recorder only adds a knot where the curve from the last knot would
+ * pass more than GHOST_POSITION_TOLERANCE or GHOST_ROTATION_TOLERANCE from a
+ * recorded tick, so knots gather where the car hits something or the throttle
+ * changes and a long steady stretch costs one.
+ *
+ * A knot is five Exp-Golomb codes packed as bits: ticks since the previous knot,
+ * change of facing (1/2048 turn) and speed (1/32 px per tick), then the offset
+ * of x and y (1/4 px) from where the two speeds and facings predict it.
+ *
+ * No drift: knots are exact integers and each tick is evaluated from the two
+ * knots around it, not integrated from the start. The prediction and the curve
+ * use an integer sine, not libm, so a .rgh file decodes the same on every
+ * machine; only float rounding between knots can differ between compilers.
+ *
+ * Every GHOST_KEYFRAME_TICKS the last knot at or before that tick and the bit
+ * after it in the stream are kept in an index, so a seek reads about 30 s of knots.
+ */
+typedef struct {
+    int tick;
+    int x, y;                         // 1/4 px
+    int rotation;                     // 1/2048 turn, [0, 2048)
+    int speed;                        // 1/32 px per tick along the facing, negative backing up
+} GhostKnot;
+
+typedef struct {
+    GhostKnot knot;                   // The last knot at or before tick index * GHOST_KEYFRAME_TICKS
+    unsigned int offset;              // Bit where the stream continues from there
+} GhostKeyframe;
+
+typedef struct {
+    long ticks;                       // Samples recorded (the lap time, in ticks)
+    unsigned char *data;              // Encoded stream
+    size_t size, capacity;
+    size_t bits;                      // Recording only: bits written (the last byte may be part full)
+    GhostKeyframe *keys;
+    int key_count, key_capacity;
+    int world_width, world_height;    // A ghost only fits the course it was driven on
+
+    GhostKnot anchor;                 // Recording only: the last knot written
+    GhostKnot candidate;              // Recording only: a knot on the newest tick that the curve from `anchor` fits
+    float *samples;                   // Recording only: x, y, facing of each tick since `anchor`
+    float last_x, last_y;             // Recording only: the newest sample
+} Ghost;
+
+// Read position; steps forward cheaply, jumps through the keyframes
+typedef struct {
+    long tick;                        // Tick the cursor is on (-1 = not placed yet)
+    GhostKnot from, to;               // The knots around it: from.tick < tick <= to.tick (or tick 0)
+    size_t offset;                    // Bit after `to` in the stream
+} GhostCursor;
+
+typedef struct {
+    float x, y;                       // Centre, in world pixels
+    float rotation;                   // Degrees, [0, 360)
+} GhostPose;
+
+// Starts an empty recording on a world of this size
+void ghost_begin(Ghost *ghost, int world_width, int world_height);
+
+// Appends one tick; returns 0, or -1 if out of memory (the ghost is then unusable)
+int ghost_record(Ghost *ghost, float x, float y, float rotation);
+
+// Writes the knot on the last sample; call once after it
+void ghost_finish(Ghost *ghost);
+
+void ghost_free(Ghost *ghost);
+
+// Bytes held by the stream and the index
+size_t ghost_memory(const Ghost *ghost);
+
+// Places the cursor on `tick` (clamped to the lap)
+void ghost_seek(const Ghost *ghost, GhostCursor *cursor, long tick);
+
+// Seeks or steps, whichever is cheaper, so following the lap clock reads each knot once
+void ghost_advance(const Ghost *ghost, GhostCursor *cursor, long tick);
+
+// Where the ghost is, blended between the cursor's tick and the one before (alpha in [0, 1])
+GhostPose ghost_pose(const GhostCursor *cursor, float alpha);
+
+// Single file: a header, the keyframe index, then the stream. 0 or -1 (message on stderr)
+int ghost_save(const Ghost *ghost, const char *path);
+int ghost_load(Ghost *ghost, const char *path);
+
+// Loads up to `max` ghosts of this world size from `dir`, fastest laps first; returns how many
+int ghost_load_dir(Ghost *ghosts, int max, const char *dir, int world_width, int world_height);
+
+// Saves a finished lap into `dir` (created if needed) as lap_<ms>_<time>.rgh
+int ghost_save_lap(const Ghost *ghost, const char *dir);
+
+// Adds a finished lap to a set kept fastest first, dropping the slowest once
+// `max` are held; takes `lap` over (it is left empty). Returns the new count
+int ghost_keep(Ghost *ghosts, int count, int max, Ghost *lap);
+
+// ----------------------------
+// BATCHED QUADS
+// ----------------------------
+// Every ghost uses the same car texture, so they are drawn as one batch of quads
+// rather than a sprite call each. The corners are worked out here (no raylib),
+// ghost_draw() only hands them to the GPU.
+typedef struct {
+    float x[4], y[4];                 // Corners: top-left, bottom-left, bottom-right, top-right
+} GhostQuad;
+
+// One quad per pose for a car_width x car_height sprite centred on the pose
+void ghost_build_quads(const GhostPose *poses, int count, float car_width, float car_height, GhostQuad *quads);
+
+#endif
@@ -0,0 +1,24 @@
+#include <rlgl.h>
+#include "ghost_draw.h"
+#include "render_stats.h"
+
+void ghost_draw(Texture2D texture, const GhostQuad *quads, int count, Color tint){
+    if (count <= 0) return;
+    // Flush now if the whole batch would not fit, so it is never split in two
+    rlCheckRenderBatchLimit(4 * count);
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    // Corner order and UVs as in DrawTexturePro(): top-left, bottom-left, bottom-right, top-right
+    static const float u[4] = {0, 0, 1, 1}, v[4] = {0, 1, 1, 0};
+    for (int i = 0; i < count; i++) {
+        for (int k = 0; k < 4; k++) {
+            rlTexCoord2f(u[k], v[k]);
+            rlVertex2f(quads[i].x[k], quads[i].y[k]);
+        }
+    }
+    rlEnd();
+    rlSetTexture(0);
+    render_stats_count(1);
+}
@@ -0,0 +1,17 @@
+#ifndef GHOST_DRAW_H
+#define GHOST_DRAW_H
+
+#include <raylib.h>
+#include "ghost.h"
+
+// ----------------------------
+// GHOST RENDERER
+// ----------------------------
+// Draws every ghost in one batch: the texture is bound once and the quads from
+// ghost_build_quads() are streamed into rlgl's vertex buffer back to back, so
+// 100 ghosts cost one draw command instead of 100 DrawTexturePro() calls.
+
+// Must be called inside BeginMode2D(); `texture` is the player's car_texture
+void ghost_draw(Texture2D texture, const GhostQuad *quads, int count, Color tint);
+
+#endif
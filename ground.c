@@ -0,0 +1,24 @@
+#include "ground.h"
+#include "render_stats.h"
+
+void ground_init(GroundRenderer *ground, Texture2D texture){
+    ground->texture = texture;
+    SetTextureWrap(ground->texture, TEXTURE_WRAP_REPEAT);
+}
+
+void ground_draw(const GroundRenderer *ground, SimRect visible){
+    if (visible.width <= 0 || visible.height <= 0) return;
+
+    /**
+     * UV WRAPPING
+     * -----------
+     * The source rectangle is given in texels and is the same as the world rectangle
+     * being covered. With TEXTURE_WRAP_REPEAT a source wider than the texture just
+     * repeats it, so texel (x mod 512, y mod 512) lands on world pixel (x, y) — the
+     * exact image the old per-tile loop produced, without drawing outside the world.
+     */
+    Rectangle source = {visible.x, visible.y, visible.width, visible.height};
+    Rectangle dest = {visible.x, visible.y, visible.width, visible.height};
+    DrawTexturePro(ground->texture, source, dest, (Vector2){0, 0}, 0, WHITE);
+    render_stats_count(1);
+}
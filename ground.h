@@ -0,0 +1,25 @@
+#ifndef GROUND_H
+#define GROUND_H
+
+#include <raylib.h>
+#include "sim.h"
+
+// ----------------------------
+// GROUND RENDERER
+// ----------------------------
+// Covers the visible part of the world with the soil tile in a single textured
+// quad. The texture is set to repeat, so the quad's UVs simply run past 1.0 and
+// the GPU tiles it; the cost is one draw command at any zoom or world size.
+
+typedef struct {
+    Texture2D texture;   // Tile texture (one texel per world pixel)
+} GroundRenderer;
+
+// Takes the soil texture and switches it to repeat wrapping
+void ground_init(GroundRenderer *ground, Texture2D texture);
+
+// Draws the ground over `visible` (world pixels, already clipped to the world).
+// Must be called inside BeginMode2D().
+void ground_draw(const GroundRenderer *ground, SimRect visible);
+
+#endif
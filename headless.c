@@ -0,0 +1,173 @@
+#define _POSIX_C_SOURCE 199309L
+#include "headless.h"
+#include "sim.h"
+#include "app.h"
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HEADLESS_VIEW_WIDTH 1300    // Same viewport as the windowed game
+#define HEADLESS_VIEW_HEIGHT 1000
+#define HEADLESS_CAR_WIDTH 120      // Car_1_01.png rotated and scaled to 120px wide
+#define HEADLESS_CAR_HEIGHT 59
+#define HEADLESS_TILE_SIZE 512
+
+// ----------------------------
+// SCRIPTED INPUT
+// ----------------------------
+/**
+ * INPUT SCRIPT
+ * ------------
+ * A tiny LCG picks a key combination and holds it for 0.25–2 seconds, like a player
+ * would. Throttle is held most of the time so the car regularly reaches the world
+ * edges, which exercises the boundary and camera-clamping branches as well as the
+ * open-field path. The same seed always produces the same session.
+ */
+typedef struct {
+    unsigned int rng;
+    unsigned int input;
+    long ticks_left;
+} InputScript;
+
+static unsigned int script_rand(InputScript *script){
+    script->rng = script->rng * 1664525u + 1013904223u;
+    return script->rng >> 8;
+}
+
+static unsigned int script_next(InputScript *script){
+    if (script->ticks_left <= 0) {
+        unsigned int roll = script_rand(script);
+        unsigned int input = 0;
+        switch (roll % 8) {
+            case 0: input = 0; break;                              // coast
+            case 1: input = SIM_INPUT_DOWN; break;                 // brake / reverse
+            case 2: input = SIM_INPUT_DOWN | SIM_INPUT_LEFT; break;
+            default: input = SIM_INPUT_UP; break;                  // throttle
+        }
+        roll = script_rand(script);
+        if (roll % 3 == 0) input |= SIM_INPUT_LEFT;
+        else if (roll % 3 == 1) input |= SIM_INPUT_RIGHT;
+        script->input = input;
+        script->ticks_left = SIM_TICK_RATE / 4 + script_rand(script) % (SIM_TICK_RATE * 7 / 4);
+    }
+    script->ticks_left--;
+    return script->input;
+}
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_ns(const void *a, const void *b){
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+void headless_default_options(HeadlessOptions *options){
+    options->ticks = 200000;
+    options->seed = 12345;
+    options->record = NULL;
+}
+
+void headless_parse_args(HeadlessOptions *options, int argc, char **argv){
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--ticks") == 0) options->ticks = atol(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0) options->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--record") == 0) options->record = argv[++i];
+    }
+    if (options->ticks < 1) options->ticks = 1;
+}
+
+// One tick of game work: the simulation step plus the tile culling the renderer does
+static long run_tick(SimState *sim, unsigned int input){
+    sim_step(sim, input);
+    SimTileRange tiles = sim_visible_tiles(sim, sim->camera_x, sim->camera_y, 1.0f, HEADLESS_TILE_SIZE);
+    if (tiles.end_x < tiles.start_x || tiles.end_y < tiles.start_y) return 0;
+    return (long)(tiles.end_x - tiles.start_x + 1) * (tiles.end_y - tiles.start_y + 1);
+}
+
+static int headless_init_sim(SimState *sim){
+    if (sim_init(sim, SIM_WORLD_WIDTH, SIM_WORLD_HEIGHT, HEADLESS_VIEW_WIDTH, HEADLESS_VIEW_HEIGHT,
+                 HEADLESS_CAR_WIDTH, HEADLESS_CAR_HEIGHT, SIM_TRAFFIC_COUNT) != 0) {
+        fprintf(stderr, "headless: could not allocate the simulation\n");
+        return -1;
+    }
+    return 0;
+}
+
+int headless_run(const HeadlessOptions *options){
+    long ticks = options->ticks;
+    long long *samples = malloc(sizeof *samples * ticks);
+    if (!samples) {
+        fprintf(stderr, "headless: could not allocate %ld samples\n", ticks);
+        return 1;
+    }
+
+    /**
+     * TWO PASSES
+     * ----------
+     * Reading the clock costs about as much as a tick, so throughput is measured on
+     * an untimed pass and the latency percentiles on a second pass with a clock read
+     * around every tick. Both passes replay the same script, so they must end in the
+     * same state; a mismatch means the simulation is not deterministic.
+     */
+    SimState sim;
+    InputScript script = {options->seed, 0, 0};
+    long tiles_drawn = 0;
+    if (headless_init_sim(&sim) != 0) {
+        free(samples);
+        return 1;
+    }
+    long long start = now_ns();
+    for (long i = 0; i < ticks; i++) tiles_drawn += run_tick(&sim, script_next(&script));
+    long long elapsed = now_ns() - start;
+    unsigned int hash = sim_hash(&sim);
+    SimCar player = sim_vehicle(&sim, SIM_PLAYER, 1);
+    sim_free(&sim);
+
+    script = (InputScript){options->seed, 0, 0};
+    if (headless_init_sim(&sim) != 0) {
+        free(samples);
+        return 1;
+    }
+    // The second pass can also be saved as a replay, starting straight in GAME
+    App app;
+    ReplayRecorder recorder;
+    app_init(&app, HEADLESS_VIEW_WIDTH, HEADLESS_VIEW_HEIGHT);
+    app.state = GAME;
+    int recording = options->record && replay_record_begin(&recorder, options->record, &sim, &app) == 0;
+    for (long i = 0; i < ticks; i++) {
+        unsigned int input = script_next(&script);
+        if (recording) replay_record_tick(&recorder, input);
+        long long t0 = now_ns();
+        run_tick(&sim, input);
+        samples[i] = now_ns() - t0;
+    }
+    if (recording) replay_record_end(&recorder, &sim, &app);
+    unsigned int check = sim_hash(&sim);
+    sim_free(&sim);
+    qsort(samples, ticks, sizeof *samples, compare_ns);
+
+    double seconds = elapsed / 1e9;
+    printf("headless: %ld ticks (%.1f s of game time) in %.3f s\n", ticks, (double)ticks / SIM_TICK_RATE, seconds);
+    printf("  throughput  %.0f ticks/sec, %.1f ns/tick\n", ticks / seconds, (double)elapsed / ticks);
+    printf("  latency     p50 %lld ns, p90 %lld ns, p99 %lld ns, max %lld ns\n",
+           samples[ticks / 2], samples[ticks * 9 / 10], samples[ticks * 99 / 100], samples[ticks - 1]);
+    printf("  tiles/tick  %.2f\n", (double)tiles_drawn / ticks);
+    printf("  vehicles    %d (player + traffic)\n", 1 + SIM_TRAFFIC_COUNT);
+    printf("  final car   x=%.2f y=%.2f rot=%.2f speed=%.2f\n", player.x, player.y, player.rotation, player.speed);
+    printf("  state hash  %08x\n", hash);
+
+    free(samples);
+    if (options->record && !recording) return 1;
+    if (check != hash) {
+        fprintf(stderr, "headless: passes disagree (%08x vs %08x), simulation is not deterministic\n", hash, check);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// ----------------------------
+// HEADLESS SIMULATION RUNNER
+// ----------------------------
+// Drives the simulation from a scripted input source without opening a window or
+// the audio device, and reports how fast the tick runs. Used by `main --headless`
+// and by the `make bench` target.
+
+typedef struct {
+    long ticks;             // Number of simulation ticks to run
+    unsigned int seed;      // Seed for the scripted input
+    const char *record;     // Write the session to this replay file, or NULL
+} HeadlessOptions;
+
+// Fills in the defaults (200k ticks, fixed seed)
+void headless_default_options(HeadlessOptions *options);
+
+// Parses --ticks N, --seed N and --record FILE out of argv, ignoring anything it doesn't know
+void headless_parse_args(HeadlessOptions *options, int argc, char **argv);
+
+// Runs the scripted session and prints the report; returns 0 on success
+int headless_run(const HeadlessOptions *options);
+
+#endif
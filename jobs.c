@@ -0,0 +1,249 @@
+#define _POSIX_C_SOURCE 200112L
+#include "jobs.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    JobFunction function;
+    void *data;
+    int begin, end;
+    JobCounter *after;     // Must be zero before the job may start (NULL = no dependency)
+    JobCounter *counter;   // Lowered when the job is done
+} Job;
+
+// Ring of jobs; the owner takes the newest (back), thieves the oldest (front)
+typedef struct {
+    pthread_mutex_t lock;
+    Job jobs[JOBS_QUEUE_CAPACITY];
+    int head;
+    int count;             // Written under the lock, peeked at without it
+} JobQueue;
+
+static struct {
+    int thread_count;      // 1 = no pool, everything runs inline
+    pthread_t threads[JOBS_MAX_THREADS];
+    JobQueue *queues;      // [0] shared by threads outside the pool, [i] worker i
+    int queue_count;
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+    int queued;            // Jobs waiting in any queue
+    int sleeping;          // Workers blocked on `wake`
+    int quit;
+    JobStats stats;
+} pool = {.thread_count = 1};
+
+static __thread int own_queue;   // 0 on every thread the pool did not start
+
+// ----------------------------
+// QUEUES
+// ----------------------------
+static int queue_push(JobQueue *queue, Job job){
+    pthread_mutex_lock(&queue->lock);
+    int ok = queue->count < JOBS_QUEUE_CAPACITY;
+    if (ok) {
+        queue->jobs[(queue->head + queue->count) % JOBS_QUEUE_CAPACITY] = job;
+        __atomic_store_n(&queue->count, queue->count + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok;
+}
+
+static int job_ready(const Job *job){
+    return !job->after || __atomic_load_n(&job->after->pending, __ATOMIC_ACQUIRE) == 0;
+}
+
+/**
+ * TAKING A JOB
+ * ------------
+ * The first job whose dependency is met is taken, starting from the newest end
+ * for the owner (still warm in its cache) or the oldest end for a thief (the
+ * biggest leftovers of whatever the owner split up). Jobs still waiting on
+ * another counter stay where they are, and so do jobs not counted on `only`
+ * when it is set.
+ */
+static int queue_pop(JobQueue *queue, Job *job, int newest, const JobCounter *only){
+    if (__atomic_load_n(&queue->count, __ATOMIC_RELAXED) == 0) return 0;
+    pthread_mutex_lock(&queue->lock);
+    int found = -1;
+    for (int k = 0; k < queue->count && found < 0; k++) {
+        int index = newest ? queue->count - 1 - k : k;
+        const Job *candidate = &queue->jobs[(queue->head + index) % JOBS_QUEUE_CAPACITY];
+        if ((!only || candidate->counter == only) && job_ready(candidate)) found = index;
+    }
+    if (found >= 0) {
+        *job = queue->jobs[(queue->head + found) % JOBS_QUEUE_CAPACITY];
+        if (found == 0) {
+            queue->head = (queue->head + 1) % JOBS_QUEUE_CAPACITY;
+        } else {
+            // Close the gap (nothing to move when it was the newest job)
+            for (int k = found; k < queue->count - 1; k++) {
+                queue->jobs[(queue->head + k) % JOBS_QUEUE_CAPACITY] = queue->jobs[(queue->head + k + 1) % JOBS_QUEUE_CAPACITY];
+            }
+        }
+        __atomic_store_n(&queue->count, queue->count - 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found >= 0;
+}
+
+// Runs one job from this thread's queue or, failing that, one stolen from another;
+// only jobs counted on `only` unless it is NULL
+static int run_one(const JobCounter *only){
+    Job job;
+    int self = own_queue;
+    int threads = jobs_thread_count();
+    int found = queue_pop(&pool.queues[self], &job, 1, only);
+    int stolen = 0;
+    for (int i = 1; !found && i < threads; i++) {
+        found = stolen = queue_pop(&pool.queues[(self + i) % threads], &job, 0, only);
+    }
+    if (!found) return 0;
+    __atomic_sub_fetch(&pool.queued, 1, __ATOMIC_SEQ_CST);
+    job.function(job.data, job.begin, job.end);
+    __atomic_sub_fetch(&job.counter->pending, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool.stats.executed, 1, __ATOMIC_RELAXED);
+    if (stolen) __atomic_add_fetch(&pool.stats.stolen, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+// ----------------------------
+// WORKERS
+// ----------------------------
+/**
+ * SLEEPING
+ * --------
+ * A worker with nothing to run or steal sleeps on `wake` until `queued` is
+ * non-zero. It announces itself in `sleeping` before checking `queued`, and a
+ * poster raises `queued` before checking `sleeping`, so one of the two always
+ * sees the other: either the worker finds the job or the poster wakes it.
+ */
+static void *worker_main(void *arg){
+    own_queue = (int)(intptr_t)arg;
+    for (;;) {
+        if (run_one(NULL)) continue;
+        pthread_mutex_lock(&pool.sleep_lock);
+        __atomic_add_fetch(&pool.sleeping, 1, __ATOMIC_SEQ_CST);
+        while (!pool.quit && __atomic_load_n(&pool.queued, __ATOMIC_SEQ_CST) == 0) {
+            pthread_cond_wait(&pool.wake, &pool.sleep_lock);
+        }
+        __atomic_sub_fetch(&pool.sleeping, 1, __ATOMIC_SEQ_CST);
+        int quit = pool.quit && __atomic_load_n(&pool.queued, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&pool.sleep_lock);
+        if (quit) break;
+        // Jobs are queued but none could be taken (waiting on a dependency, or just
+        // grabbed by someone else): let the threads they wait for run
+        if (!run_one(NULL)) sched_yield();
+    }
+    return NULL;
+}
+
+int jobs_init(int threads){
+    jobs_shutdown();
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > JOBS_MAX_THREADS) threads = JOBS_MAX_THREADS;
+    if (threads <= 1) return 0;
+
+    pool.queues = calloc(threads, sizeof *pool.queues);
+    if (!pool.queues) return -1;
+    pool.queue_count = threads;
+    for (int i = 0; i < threads; i++) pthread_mutex_init(&pool.queues[i].lock, NULL);
+    pthread_mutex_init(&pool.sleep_lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+    pool.quit = 0;
+    __atomic_store_n(&pool.thread_count, threads, __ATOMIC_RELEASE);   // Workers steal from every queue
+    int started = 1;
+    while (started < threads && pthread_create(&pool.threads[started], NULL, worker_main, (void *)(intptr_t)started) == 0) {
+        started++;
+    }
+    // Fewer workers than asked for: nothing is queued yet, so shrinking is safe
+    __atomic_store_n(&pool.thread_count, started, __ATOMIC_RELEASE);
+    if (started == 1) {
+        jobs_shutdown();
+        return -1;
+    }
+    return 0;
+}
+
+void jobs_shutdown(void){
+    if (!pool.queues) return;
+    pthread_mutex_lock(&pool.sleep_lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.sleep_lock);
+    for (int i = 1; i < pool.thread_count; i++) pthread_join(pool.threads[i], NULL);
+    for (int i = 0; i < pool.queue_count; i++) pthread_mutex_destroy(&pool.queues[i].lock);
+    pthread_mutex_destroy(&pool.sleep_lock);
+    pthread_cond_destroy(&pool.wake);
+    free(pool.queues);
+    pool.queues = NULL;
+    __atomic_store_n(&pool.thread_count, 1, __ATOMIC_RELEASE);
+}
+
+int jobs_thread_count(void){
+    return __atomic_load_n(&pool.thread_count, __ATOMIC_ACQUIRE);
+}
+
+void jobs_stats(JobStats *stats){
+    stats->executed = __atomic_load_n(&pool.stats.executed, __ATOMIC_RELAXED);
+    stats->stolen = __atomic_load_n(&pool.stats.stolen, __ATOMIC_RELAXED);
+    stats->inline_runs = __atomic_load_n(&pool.stats.inline_runs, __ATOMIC_RELAXED);
+}
+
+// ----------------------------
+// POSTING AND WAITING
+// ----------------------------
+void jobs_run(JobFunction function, void *data, int begin, int end, int grain,
+              JobCounter *after, JobCounter *counter){
+    if (end <= begin) return;
+    if (grain < 1) grain = 1;
+    if (jobs_thread_count() == 1 || (end - begin <= grain && (!after || __atomic_load_n(&after->pending, __ATOMIC_ACQUIRE) == 0))) {
+        if (after) jobs_wait(after);
+        function(data, begin, end);
+        __atomic_add_fetch(&pool.stats.inline_runs, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    JobQueue *queue = &pool.queues[own_queue];
+    for (int start = begin; start < end; start += grain) {
+        Job job = {function, data, start, end - start > grain ? start + grain : end, after, counter};
+        __atomic_add_fetch(&counter->pending, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pool.queued, 1, __ATOMIC_SEQ_CST);
+        if (!queue_push(queue, job)) {
+            // Queue full: do it here instead
+            __atomic_sub_fetch(&pool.queued, 1, __ATOMIC_SEQ_CST);
+            if (after) jobs_wait(after);
+            function(data, job.begin, job.end);
+            __atomic_sub_fetch(&counter->pending, 1, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&pool.stats.inline_runs, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_load_n(&pool.sleeping, __ATOMIC_SEQ_CST) > 0) {
+            pthread_mutex_lock(&pool.sleep_lock);
+            pthread_cond_signal(&pool.wake);
+            pthread_mutex_unlock(&pool.sleep_lock);
+        }
+    }
+}
+
+/**
+ * HELPING, NOT MOONLIGHTING
+ * -------------------------
+ * A waiting thread only runs jobs of the batch it waits for. Queue 0 is shared by
+ * every thread outside the pool, so otherwise the render thread, waiting on the
+ * simulation's cars, could pick up a chunk the streamer posted and miss its frame;
+ * the workers take whatever is left. Chained batches are waited on one at a time
+ * to help with each of them.
+ */
+void jobs_wait(JobCounter *counter){
+    while (__atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE) > 0) {
+        if (!run_one(counter)) sched_yield();
+    }
+}
+
+void parallel_for(int begin, int end, int grain, JobFunction function, void *data){
+    JobCounter counter = {0};
+    jobs_run(function, data, begin, end, grain, NULL, &counter);
+    jobs_wait(&counter);
+}
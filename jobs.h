@@ -0,0 +1,65 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+// ----------------------------
+// JOB SYSTEM
+// ----------------------------
+// A pool of worker threads, each with its own queue of jobs. A worker that runs
+// out of jobs steals from the others, so a frame's work spreads over every core
+// without anyone handing it out. Threads outside the pool (the main thread, the
+// chunk streamer) post into a shared queue and help run their own jobs while they
+// wait.
+// Until jobs_init() is called, or with one thread, every job runs inline on the
+// caller, so single-threaded tools need no setup.
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_QUEUE_CAPACITY 1024   // Per queue; a job that does not fit runs inline
+
+// Processes items [begin, end) of whatever `data` describes
+typedef void (*JobFunction)(void *data, int begin, int end);
+
+/**
+ * COUNTERS
+ * --------
+ * Every job is attached to a counter that is raised when the job is posted and
+ * lowered when it finishes. Waiting for a counter to reach zero is a fence for a
+ * whole batch; jobs posted "after" a counter only start once it is zero, which
+ * chains batches without the poster waiting in between. A counter must start at
+ * zero and stay in scope until jobs_wait() on it returns.
+ */
+typedef struct {
+    int pending;
+} JobCounter;
+
+typedef struct {
+    unsigned long executed;   // Jobs run, inline ones excluded
+    unsigned long stolen;     // ... of which taken from another thread's queue
+    unsigned long inline_runs;  // Ranges run straight on the caller (small or no pool)
+} JobStats;
+
+// Starts `threads` - 1 workers (the caller makes up the last); 0 = one per core.
+// Returns 0 on success, -1 if no worker could be started (jobs then run inline).
+int jobs_init(int threads);
+
+// Waits for the workers to finish and stops them
+void jobs_shutdown(void);
+
+// Threads that can run jobs, the caller included (1 without a pool)
+int jobs_thread_count(void);
+
+void jobs_stats(JobStats *stats);
+
+// Posts [begin, end) split into jobs of at most `grain` items. They start once
+// `after` (may be NULL) is done and count on `counter`. A range that is a single
+// job and has nothing to wait for runs inline right away.
+void jobs_run(JobFunction function, void *data, int begin, int end, int grain,
+              JobCounter *after, JobCounter *counter);
+
+// Runs jobs counted on `counter` until it is zero; other threads' work is left to
+// the pool. Wait on each counter of a chain to help with every batch.
+void jobs_wait(JobCounter *counter);
+
+// jobs_run() + jobs_wait(): returns when every item has been processed
+void parallel_for(int begin, int end, int grain, JobFunction function, void *data);
+
+#endif
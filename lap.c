@@ -0,0 +1,65 @@
+#include "lap.h"
+#include <math.h>
+#include <string.h>
+
+#define PI 3.14159265358979323846f
+
+void lap_course_init(LapCourse *course, int world_width, int world_height){
+    float cx = world_width / 2.0f, cy = world_height / 2.0f;
+    float radius = (world_width < world_height ? world_width : world_height) * LAP_COURSE_RADIUS;
+    for (int i = 0; i < LAP_GATE_COUNT; i++) {
+        // Screen y points down, so growing angles go clockwise; gate 0 is straight up
+        float angle = -PI / 2 + i * (2 * PI / LAP_GATE_COUNT);
+        course->x[i] = cx + cosf(angle) * radius;
+        course->y[i] = cy + sinf(angle) * radius;
+    }
+    course->radius = LAP_GATE_RADIUS;
+}
+
+void lap_timer_init(LapTimer *timer){
+    memset(timer, 0, sizeof *timer);
+}
+
+/**
+ * GATE CROSSING
+ * -------------
+ * At top speed a car covers 50 px per tick, so only checking where it ended up
+ * could jump over a gate's edge. The whole segment it drove during the tick is
+ * tested instead: its closest point to the gate centre must be inside the circle.
+ */
+static int passes_gate(const LapCourse *course, int gate, float x0, float y0, float x1, float y1){
+    float dx = x1 - x0, dy = y1 - y0;
+    float length2 = dx * dx + dy * dy;
+    float t = length2 > 0 ? ((course->x[gate] - x0) * dx + (course->y[gate] - y0) * dy) / length2 : 0;
+    t = fminf(fmaxf(t, 0), 1);
+    float ex = x0 + dx * t - course->x[gate], ey = y0 + dy * t - course->y[gate];
+    return ex * ex + ey * ey <= course->radius * course->radius;
+}
+
+unsigned int lap_timer_update(LapTimer *timer, const LapCourse *course, const SimState *sim){
+    const VehicleStore *vehicles = &sim->vehicles;
+    int car = sim->focus;
+    if (!passes_gate(course, timer->next_gate, vehicles->prev_x[car], vehicles->prev_y[car], vehicles->x[car], vehicles->y[car])) {
+        return 0;
+    }
+    if (!timer->started) {
+        timer->started = 1;
+        timer->lap_start = sim->tick;
+        timer->next_gate = 1;
+        return LAP_EVENT_START;
+    }
+    if (timer->next_gate != 0) {
+        timer->next_gate = (timer->next_gate + 1) % LAP_GATE_COUNT;
+        return LAP_EVENT_CHECKPOINT;
+    }
+    timer->last_lap = (long)(sim->tick - timer->lap_start);
+    if (timer->best_lap == 0 || timer->last_lap < timer->best_lap) timer->best_lap = timer->last_lap;
+    timer->laps++;
+    timer->lap_start = sim->tick;
+    timer->next_gate = 1;
+    return LAP_EVENT_FINISH;
+}
+
+long lap_timer_current(const LapTimer *timer, const SimState *sim){
+    return timer->started ? (long)(sim->tick - timer->lap_start) : 0;
+}
@@ -0,0 +1,47 @@
+#ifndef LAP_H
+#define LAP_H
+
+#include "sim.h"
+
+// ----------------------------
+// LAP COURSE AND TIMING
+// ----------------------------
+// A loop of round gates around the middle of the world. Gate 0 is the start and
+// finish line; the others are checkpoints that must be passed in order, so a lap
+// only counts if the whole loop was driven. Raylib-free: main.c draws the gates.
+
+#define LAP_GATE_COUNT 8                // Start/finish + 7 checkpoints, clockwise from the top
+#define LAP_COURSE_RADIUS 0.33f         // Of the world's smaller side
+#define LAP_GATE_RADIUS 400.0f          // Pixels; wide enough to hit at top speed
+
+typedef struct {
+    float x[LAP_GATE_COUNT], y[LAP_GATE_COUNT];   // Gate centres
+    float radius;
+} LapCourse;
+
+typedef enum {
+    LAP_EVENT_START      = 1 << 0,      // First crossing of the start line: the clock runs
+    LAP_EVENT_CHECKPOINT = 1 << 1,      // The next gate was passed
+    LAP_EVENT_FINISH     = 1 << 2,      // A lap was completed (and the next one started)
+} LapEvent;
+
+typedef struct {
+    int started;
+    int next_gate;                      // Gate to pass next (0 = the finish line)
+    unsigned long lap_start;            // sim->tick the current lap started at
+    long last_lap, best_lap;            // In ticks; 0 = none yet
+    int laps;                           // Completed
+} LapTimer;
+
+void lap_course_init(LapCourse *course, int world_width, int world_height);
+
+void lap_timer_init(LapTimer *timer);
+
+// Checks the followed car's move during the last tick against the next gate;
+// returns the LapEvent bits that happened
+unsigned int lap_timer_update(LapTimer *timer, const LapCourse *course, const SimState *sim);
+
+// Ticks into the current lap (0 before the start line was crossed)
+long lap_timer_current(const LapTimer *timer, const SimState *sim);
+
+#endif
@@ -2,19 +2,119 @@
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include "sim.h"
+#include "headless.h"
+#include "ground.h"
+#include "render_stats.h"
+#include "assets.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "app.h"
+#include "replay.h"
+#include "world.h"
+#include "world_draw.h"
+#include "pacing.h"
+#include "config.h"
+#include "audio.h"
+#include "ui.h"
+#include "jobs.h"
+#include "netplay.h"
+#include "lap.h"
+#include "ghost_draw.h"
 
 #define BACKGROUND_COLOR (Color){186,149,127}  // Background color for the game window
 #define CAR_COLOR BLACK                        // Car color (not directly used since car is textured)
-#define ROTATION_SPEED 52                      // Rotation speed of the car in degrees per second
+#define GHOSTS_MAX 64                          // Fastest laps kept and raced against
 
-// Enum to define game states (screens)
-typedef enum {
-    MENU,       // Main menu (shows Play + Settings options)
-    GAME,       // Gameplay screen (car driving in the world)
-    SETTINGS    // Settings screen (adjust FPS, go back)
-} GameState;
+static Rectangle to_rectangle(SimRect rect){
+    return (Rectangle){rect.x, rect.y, rect.width, rect.height};
+}
+
+// F4 panel in a networked game: what the link costs and how often prediction was wrong
+static void draw_net_stats(const NetClient *client, int x, int y){
+    const NetClientStats *stats = &client->stats;
+    int players = 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) players += (client->active >> i) & 1;
+    DrawRectangle(x - 5, y - 5, 470, 130, Fade(BLACK, 0.6f));
+    DrawText(TextFormat("Player %d of %d, rtt %.0f ms (+%d ms lag, %d%% loss)", client->id, players, stats->rtt_ms,
+                        client->socket.conditions.lag_ms, client->socket.conditions.loss_percent), x, y, 20, WHITE);
+    DrawText(TextFormat("Down %.2f KB/s, up %.2f KB/s", stats->down_rate / 1024, stats->up_rate / 1024), x, y + 25, 20, WHITE);
+    DrawText(TextFormat("Snapshot %.1f B avg, %lu of %lu full, %lu stale",
+                        stats->snapshots ? (double)stats->snapshot_bytes / stats->snapshots : 0.0,
+                        stats->full_snapshots, stats->snapshots, stats->stale_snapshots), x, y + 50, 20, WHITE);
+    DrawText(TextFormat("Correction %.2f px (max %.2f), %lu corrected", stats->correction, stats->correction_max,
+                        stats->corrections), x, y + 75, 20, WHITE);
+    DrawText(TextFormat("Packets lost %lu", client->socket.packets_dropped), x, y + 100, 20, WHITE);
+}
+
+// Lap clock in the top right: m:ss.cc from ticks
+static const char *format_lap(long ticks){
+    long centis = ticks * 100 / SIM_TICK_RATE;
+    return TextFormat("%ld:%02ld.%02ld", centis / 6000, centis / 100 % 60, centis % 100);
+}
+
+// The pacer does all the waiting; raylib's own frame limiter stays off
+static void apply_pacing(Pacer *pacer, const App *app){
+    SetTargetFPS(0);
+    if (app->pacing_mode == PACING_VSYNC) SetWindowState(FLAG_VSYNC_HINT);
+    else ClearWindowState(FLAG_VSYNC_HINT);
+    pacing_set(pacer, (PacingMode)app->pacing_mode, app->target_fps);
+}
+
+int main(int argc, char **argv){
+    double launch_time = assets_clock(); // For the time-to-first-frame report
+
+    // ----------------------------
+    // HEADLESS MODE (no window, no audio)
+    // ----------------------------
+    // `./main --headless [--ticks N] [--seed N]` runs the simulation from a scripted
+    // input and prints timing, without touching raylib at all. `./main --replay FILE`
+    // plays a recording back the same way and checks its end state. `./main --server`
+    // hosts a multiplayer world (see netplay.h) in the terminal, no window either.
+    int threaded_assets = 1;   // --sync-assets: decode on the main thread like before
+    int asset_cache = 1;       // --no-asset-cache: always decode the original files
+    const char *profile_csv = NULL; // --profile-csv FILE: per-frame phase timings
+    const char *record_path = NULL; // --record FILE: save this session's input as a replay
+    int world_size = SIM_WORLD_WIDTH;           // --world-size N: width and height in pixels
+    int chunk_cache_mb = WORLD_DEFAULT_CACHE_MB; // --chunk-cache-mb N: memory for streamed chunks
+    int job_threads = 0;                         // --threads N: job system size (0 = one per core)
+    int target_fps = 0;                          // --target-fps N: any frame rate for this session (0 = config)
+    const char *connect_to = NULL;               // --connect HOST[:PORT]: join a server instead of playing alone
+    NetConditions net_conditions = {0, 0};       // --net-lag MS, --net-loss PCT: make the link worse on purpose
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            HeadlessOptions options;
+            headless_default_options(&options);
+            headless_parse_args(&options, argc, argv);
+            return headless_run(&options);
+        }
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) return replay_run(argv[i + 1]);
+        if (strcmp(argv[i], "--server") == 0) {
+            NetServerOptions options;
+            net_server_default_options(&options);
+            net_server_parse_args(&options, argc, argv);
+            return net_server_run(&options);
+        }
+        if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) connect_to = argv[++i];
+        if (strcmp(argv[i], "--net-lag") == 0 && i + 1 < argc) net_conditions.lag_ms = atoi(argv[++i]);
+        if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) net_conditions.loss_percent = atoi(argv[++i]);
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) record_path = argv[++i];
+        if (strcmp(argv[i], "--world-size") == 0 && i + 1 < argc) world_size = atoi(argv[++i]);
+        if (strcmp(argv[i], "--chunk-cache-mb") == 0 && i + 1 < argc) chunk_cache_mb = atoi(argv[++i]);
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) job_threads = atoi(argv[++i]);
+        if (strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) target_fps = atoi(argv[++i]);
+        if (strcmp(argv[i], "--sync-assets") == 0) threaded_assets = 0;
+        if (strcmp(argv[i], "--no-asset-cache") == 0) asset_cache = 0;
+        if (strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) profile_csv = argv[++i];
+    }
+    if (profile_csv && profiler_open_csv(profile_csv) != 0) {
+        fprintf(stderr, "Could not open %s for writing\n", profile_csv);
+        return 1;
+    }
+    // Worker pool for vehicle updates, the broadphase and chunk generation
+    if (jobs_init(job_threads) != 0) fprintf(stderr, "Could not start the job system, running single-threaded\n");
 
-int main(){
     // ----------------------------
     // WINDOW AND INITIALIZATION
     // ----------------------------
@@ -26,48 +126,124 @@ int main(){
     InitAudioDevice(); 
     // Initializes the audio system (needed before loading or playing any sounds/music).
 
-    GameState current_state = MENU; // The game starts on the main menu screen
-    int target_fps = 60;            // Default FPS set to 60
-    SetTargetFPS(target_fps);       
-    // SetTargetFPS() makes the game loop run consistently across computers.
+    App app;
+    app_init(&app, width, height); // Starts on the main menu
+    GameConfig config;             // Pacing mode, target FPS and sound volume from the last session
+    config_default(&config);
+    config_load(&config, CONFIG_PATH);
+    app.pacing_mode = config.pacing_mode;
+    app.sound_volume = config.sound_volume;
+    app_set_target_fps(&app, target_fps > 0 ? target_fps : config.target_fps);
+    Pacer pacer;                   // Waits for each frame's deadline and measures jitter/latency
+    pacing_init(&pacer, (PacingMode)app.pacing_mode, app.target_fps);
+    apply_pacing(&pacer, &app);
 
     // ----------------------------
     // LOAD RESOURCES (textures, sounds, music)
     // ----------------------------
-    Texture2D menu_background = LoadTexture("home_page_background.jpg"); // Menu background image
-    Sound button_sound = LoadSound("coin-collect-retro-8-bit-sound-effect-145251.mp3"); // Sound effect when buttons clicked
-    Music menu_music = LoadMusicStream("8-bit-heaven-26287.mp3"); // Background music for the menu
+    /**
+     * LOADING SCREEN
+     * --------------
+     * Images and the button sound are decoded on a worker thread (or read straight
+     * from .cache/ after the first launch) while this loop keeps the window alive
+     * with a progress bar. Each finished image is uploaded to the GPU here, since
+     * only the thread that owns the OpenGL context may create textures.
+     */
+    int exit_code = 0;   // Set by a setup step that fails; it then skips to the cleanup of what came before it
+    AssetLoader assets;
+    assets_start(&assets, width, height, threaded_assets, asset_cache);
+    double first_frame_time = 0;
+    while (!assets_update(&assets)) {
+        if (WindowShouldClose()) goto unload_assets;
+        BeginDrawing();
+        ClearBackground(BACKGROUND_COLOR);
+        DrawText("Loading...", width/2 - MeasureText("Loading...", 40)/2, height/2 - 60, 40, BLACK);
+        DrawRectangleLines(width/2 - 200, height/2, 400, 30, BLACK);
+        DrawRectangle(width/2 - 196, height/2 + 4, (int)(392 * assets_progress(&assets)), 22, DARKGRAY);
+        pacing_wait(&pacer);
+        EndDrawing();
+        pacing_presented(&pacer);
+        if (first_frame_time == 0) first_frame_time = assets_clock();
+    }
+    double ready_time = assets_clock();
+    if (first_frame_time == 0) first_frame_time = ready_time; // Loaded before any frame (--sync-assets)
+    printf("Time to first frame: %.1f ms, assets ready: %.1f ms (%d/%d images from %s/, %s)\n",
+           (first_frame_time - launch_time) * 1000, (ready_time - launch_time) * 1000,
+           assets.cache_hits, ASSET_IMAGE_COUNT, ASSET_CACHE_DIR, assets.threaded ? "worker thread" : "main thread");
 
-    Texture2D arrow_left = LoadTexture("left-arrow.png");  // Arrow for settings menu
-    Texture2D arrow_right = LoadTexture("right-arrow.png");
+    Texture2D menu_background = assets.textures[ASSET_MENU_BACKGROUND]; // Menu background image
 
-    PlayMusicStream(menu_music); // Start playing background menu music in a loop
+    Texture2D arrow_left = assets.textures[ASSET_ARROW_LEFT];  // Arrow for settings menu
+    Texture2D arrow_right = assets.textures[ASSET_ARROW_RIGHT];
 
     // ----------------------------
-    // UI BUTTONS (Rectangles used for detecting clicks)
+    // AUDIO (sounds and music are owned by the audio thread from here on)
     // ----------------------------
-    Rectangle play_button = {width/2 - 100, height/2 - 50, 200, 60};     // "Play" button in menu
-    Rectangle settings_button = {width/2 - 100, height/2 + 50, 200, 60}; // "Settings" button in menu
+    AudioSystem audio;
+    Sound sounds[AUDIO_SOUND_COUNT] = {[AUDIO_SFX_BUTTON] = assets.button_sound}; // Sound effect when buttons clicked
+    Music tracks[AUDIO_TRACK_COUNT] = {[AUDIO_TRACK_MENU] = assets.menu_music, [AUDIO_TRACK_GAME] = assets.game_music};
+    if (audio_start(&audio, sounds, tracks) != 0) {
+        fprintf(stderr, "Could not start the audio thread\n");
+        exit_code = 1;
+        goto unload_assets;
+    }
+    audio_set_music_volume(&audio, AUDIO_TRACK_GAME, 0.6f); // Keep the driving track behind the effects
+    audio_set_sound_volume(&audio, AUDIO_SFX_BUTTON, app.sound_volume / (float)APP_SOUND_STEPS);
+    audio_play_music(&audio, AUDIO_TRACK_MENU); // Start playing background menu music in a loop
 
-    Rectangle back_button = {50, 50, 100, 40}; // Back button in settings screen
-    Rectangle fps_left_arrow = {width/2 - 80, height/2 + 5, 30, 30};
-    Rectangle fps_right_arrow = {width/2 + 50, height/2 + 5, 30, 30};
+    // ----------------------------
+    // MENU SCREENS (drawn once into render textures, see ui.h)
+    // ----------------------------
+    // Buttons and arrows are laid out by app_init(), which also does the click handling
+    char fps_names[PACING_TARGET_COUNT + 1][8];   // "30" ... "240", formatted once
+    const char *fps_options[PACING_TARGET_COUNT + 1];
+    for (int i = 0; i < app.fps_choice_count; i++) {
+        snprintf(fps_names[i], sizeof fps_names[i], "%d", app.fps_choices[i]);
+        fps_options[i] = fps_names[i];
+    }
+    char sound_names[APP_SOUND_STEPS + 1][8];     // "0%" ... "100%"
+    const char *sound_options[APP_SOUND_STEPS + 1];
+    for (int i = 0; i <= APP_SOUND_STEPS; i++) {
+        snprintf(sound_names[i], sizeof sound_names[i], "%d%%", i * 100 / APP_SOUND_STEPS);
+        sound_options[i] = sound_names[i];
+    }
+    const char *setting_labels[APP_SETTING_COUNT] = {"FPS:", "Pacing:", "Sound:"};
+    const char *const *setting_options[APP_SETTING_COUNT] = {fps_options, pacing_mode_names, sound_options};
+
+    UiScreen menu_screen;
+    ui_screen_init(&menu_screen, width, height, menu_background);
+    ui_add_label(&menu_screen, "Raceee", -1, height/4, 80, BLACK);
+    ui_add_button(&menu_screen, to_rectangle(app.play_button), "PLAY", 30);
+    ui_add_button(&menu_screen, to_rectangle(app.settings_button), "SETTINGS", 30);
+
+    UiScreen settings_screen;
+    ui_screen_init(&settings_screen, width, height, menu_background);
+    ui_add_label(&settings_screen, "Settings", -1, height/4, 60, BLACK);
+    ui_add_button(&settings_screen, to_rectangle(app.back_button), "BACK", 20);
+    int setting_widgets[APP_SETTING_COUNT];
+    for (int row = 0; row < APP_SETTING_COUNT; row++) {
+        Rectangle left = to_rectangle(app.setting_left[row]);
+        ui_add_label(&settings_screen, setting_labels[row], width/2 - 260, (int)left.y, 30, BLACK);
+        setting_widgets[row] = ui_add_selector(&settings_screen, left, to_rectangle(app.setting_right[row]), arrow_left, arrow_right,
+                                               setting_options[row], app_setting_count(&app, (AppSetting)row), 30);
+    }
+    int measured_widget = ui_add_text(&settings_screen, height/2 + 10 + 50 * APP_SETTING_COUNT, 20);
+    double measured_refresh = 0;   // Next time the measured pacing line is rewritten
 
     // ----------------------------
     // GAME WORLD (map and textures)
     // ----------------------------
-    int world_width = 15000;  // World dimensions (large world for car to move in)
-    int world_height = 15000;
+    if (world_size < width) world_size = width; // At least one screen
+    int world_width = world_size;  // World dimensions (large world for car to move in)
+    int world_height = world_size;
 
-    // Load ground texture (tiles repeated for world)
-    Image soil_image = LoadImage("Soil_Tile.png");
-    ImageRotateCW(&soil_image); // Rotate image to proper orientation
-    Texture2D soil_texture = LoadTextureFromImage(soil_image);
+    // Ground texture (tiles repeated for world), already rotated by the loader
+    Texture2D soil_texture = assets.textures[ASSET_SOIL];
+    GroundRenderer ground;
+    ground_init(&ground, soil_texture); // Draws the whole visible ground as one quad
 
-    // Load car texture
-    Image car_image = LoadImage("Car_1_01.png");
-    ImageRotateCW(&car_image);
-    Texture2D car_texture = LoadTextureFromImage(car_image);
+    // Car texture (rotated and downscaled to twice the drawn size by the loader)
+    Texture2D car_texture = assets.textures[ASSET_CAR];
 
     // Define the region of the car texture (full image)
     Rectangle car_texture_rec = {
@@ -84,316 +260,363 @@ int main(){
     int car_height = (int)(car_texture.height * scale_factor);
 
     // ----------------------------
-    // CAR VARIABLES
+    // SIMULATION (player, traffic and camera, stepped at a fixed rate)
+    // ----------------------------
+    SimState sim;
+    NetClient net;               // --connect: the world comes from the server, one car per player slot
+    int online = connect_to != NULL;
+    if (online) {
+        char host[64];
+        int port = NET_DEFAULT_PORT;
+        const char *colon = strrchr(connect_to, ':');
+        size_t host_length = colon ? (size_t)(colon - connect_to) : strlen(connect_to);
+        if (colon) port = atoi(colon + 1);
+        snprintf(host, sizeof host, "%.*s", (int)host_length, connect_to);
+        if (net_client_connect(&net, host, port, &net_conditions, 3000) != 0) {
+            exit_code = 1;
+            goto free_screens;
+        }
+        if (net_client_init_sim(&net, &sim, width, height) != 0) {
+            fprintf(stderr, "Not enough memory for the shared world\n");
+            exit_code = 1;
+            goto close_net;
+        }
+        printf("Joined %s:%d as player %d\n", host, port, net.id);
+    }
+    else if (sim_init(&sim, world_width, world_height, width, height, car_width, car_height, SIM_TRAFFIC_COUNT) != 0) {
+        fprintf(stderr, "Not enough memory for %d vehicles\n", SIM_TRAFFIC_COUNT);
+        exit_code = 1;
+        goto close_net;
+    }
+    int net_panel = online;      // F4: bandwidth, snapshot size and corrections
+    unsigned int sim_input = 0;  // Keys held this frame, fed to every tick of the frame
+    float sim_accumulator = 0;   // Real time not yet simulated
+    float sim_alpha = 0;         // Fraction of a tick between the last two states
+
+    // ----------------------------
+    // STREAMED TERRAIN (tint and decorations per chunk, built on a worker thread)
     // ----------------------------
-    float car_x = world_width/2 - car_width/2;  // Start car in middle of world
-    float car_y = world_height/2 - car_height/2;
-    float car_speed = 0;                        // Car's current speed
-    float car_max_speed = 100;                  // Maximum car speed
-    int car_direction = -1;                     // Forward (-1) or backward (+1)
-    float car_rotation = -90;                   // Initial facing direction (up)
-    float car_speedup = 10;                     // Acceleration per second
-    float car_slowdown = 10;                    // Deceleration when not moving
+    World world;
+    WorldRenderer world_renderer;
+    if (world_init(&world, 2024, chunk_cache_mb) != 0) {
+        fprintf(stderr, "Could not start the chunk streamer\n");
+        exit_code = 1;
+        goto free_sim;
+    }
+    if (world_renderer_init(&world_renderer, &world) != 0) {
+        fprintf(stderr, "Not enough memory for the chunk textures\n");
+        exit_code = 1;
+        goto free_world;
+    }
+    // Start on the chunks around the spawn point while the player is still in the menu
+    world_update(&world, sim_visible_rect(&sim, sim.camera_x, sim.camera_y, 1.0f), 0, 0);
+
+    // ----------------------------
+    // LAPS AND GHOSTS (offline only: a server correction would rewind the lap clock)
+    // ----------------------------
+    LapCourse course;
+    LapTimer lap_timer;
+    lap_course_init(&course, sim.world_width, sim.world_height);
+    lap_timer_init(&lap_timer);
+    Ghost ghosts[GHOSTS_MAX];    // Fastest first, from GHOST_DIR and from this session
+    GhostCursor ghost_cursors[GHOSTS_MAX];
+    GhostQuad ghost_quads[GHOSTS_MAX];
+    GhostPose ghost_poses[GHOSTS_MAX];
+    int ghost_count = online ? 0 : ghost_load_dir(ghosts, GHOSTS_MAX, GHOST_DIR, sim.world_width, sim.world_height);
+    for (int i = 0; i < ghost_count; i++) ghost_cursors[i].tick = -1;
+    Ghost lap_ghost = {0};       // The lap being driven, from the moment it started
+    int lap_ghost_ok = 0;        // Cleared if recording ran out of memory
+    int show_ghosts = 1;         // F5
+
+    ReplayRecorder recorder;     // --record: every tick's keys, ESC and menu clicks (offline only)
+    int recording = record_path && !online && replay_record_begin(&recorder, record_path, &sim, &app) == 0;
 
     // ----------------------------
-    // CAMERA (follows car smoothly)
+    // CAMERA (follows car smoothly, target comes from the simulation)
     // ----------------------------
     Camera2D camera = {
-        .offset = (Vector2){width/2, height/2},                        // Center camera on screen
-        .target = (Vector2){car_x + car_width/2, car_y + car_height/2}, // Target is car position
+        .offset = (Vector2){width/2, height/2},                // Center camera on screen
+        .target = (Vector2){sim.camera_x, sim.camera_y},
         .rotation = 0,
         .zoom = 1.0,
     };
-    
-    float camera_threshold = 100.0f;  // How far car can move before camera follows
 
     // ----------------------------
     // MAIN GAME LOOP
     // ----------------------------
     while (!WindowShouldClose()) { // Runs until user presses ESC or closes window
+        profiler_frame_begin(); // Phases below are timed with prof_begin/prof_end (F3 shows them)
 
         float dt = GetFrameTime(); // Time in seconds between each frame
-        // dt is crucial because it makes movement consistent across different FPS.
+        // dt is banked by the simulation accumulator and spent in fixed SIM_DT ticks.
 
+        prof_begin(PROF_INPUT); // Simulation ticks inside are timed as physics/collision/camera
+        pacing_input_sampled(&pacer); // Keys and mouse are read from here on; latency runs to the present
         Vector2 mouse_pos = GetMousePosition(); // Current mouse position for button clicks
-
-        UpdateMusicStream(menu_music); // Keeps menu music streaming smoothly
+        if (IsKeyPressed(KEY_F3)) profiler.overlay = !profiler.overlay;
+        if (IsKeyPressed(KEY_F4)) net_panel = !net_panel;
+        if (IsKeyPressed(KEY_F5)) show_ghosts = !show_ghosts;
 
         // ----------------------------
         // HANDLE GAME STATES
         // ----------------------------
-        switch(current_state) {
+        unsigned int app_events = 0; // Sounds, music and FPS changes to carry out
+        switch(app.state) {
             case MENU:
-                // Play button clicked -> go to GAME
-                if (CheckCollisionPointRec(mouse_pos, play_button) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    PlaySound(button_sound);
-                    StopMusicStream(menu_music);
-                    current_state = GAME;
-                }
-                // Settings button clicked -> go to SETTINGS
-                if (CheckCollisionPointRec(mouse_pos, settings_button) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    PlaySound(button_sound);
-                    current_state = SETTINGS;
-                }
-                break;
-
             case SETTINGS:
-                // Back button clicked -> return to MENU
-                if (CheckCollisionPointRec(mouse_pos, back_button) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    PlaySound(button_sound);
-                    current_state = MENU;
-                }
-                // Left arrow clicked -> set FPS = 30
-                if (CheckCollisionPointRec(mouse_pos, fps_left_arrow) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    PlaySound(button_sound);
-                    if (target_fps == 60) {
-                        target_fps = 30;
-                        SetTargetFPS(target_fps);
-                    }
-                }
-                // Right arrow clicked -> set FPS = 60
-                if (CheckCollisionPointRec(mouse_pos, fps_right_arrow) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    PlaySound(button_sound);
-                    if (target_fps == 30) {
-                        target_fps = 60;
-                        SetTargetFPS(target_fps);
-                    }
+                // Buttons: Play/Settings in the menu, Back and the FPS arrows in settings
+                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                    if (recording) replay_record_click(&recorder, mouse_pos.x, mouse_pos.y);
+                    app_events |= app_click(&app, mouse_pos.x, mouse_pos.y);
                 }
                 break;
 
-            case GAME:                // ----------------------------
-                // CAR MOVEMENT
+            case GAME:
                 // ----------------------------
-                /**
-                 * INPUT → SPEED MODEL (FRAME-INDEPENDENT)
-                 * ---------------------------------------
-                 * We read the UP/DOWN keys each frame and convert them into acceleration on the car.
-                 *
-                 *  - dt = GetFrameTime() is the time (in seconds) between frames. Multiplying any
-                 *    per-second quantity by dt makes the motion frame-rate independent: at 30 FPS
-                 *    or 144 FPS the car covers the same distance per real second.
-                 *
-                 *  - car_speedup is the acceleration magnitude (units: pixels/second² in this setup).
-                 *    When UP is held, speed increases by (car_speedup * dt). When DOWN is held,
-                 *    we decrease speed (reverse acceleration) and flip car_direction to +1.
-                 *
-                 *  - car_direction encodes whether the car is considered moving forward (-1) or
-                 *    backward (+1). Your sprite faces upward at -90 degrees, so using -1 for
-                 *    forward keeps the sign conventions aligned with your existing rotation math.
-                 *
-                 *  - The "else" branch models passive slowdown (friction/drag). We push speed back
-                 *    toward 0 by adding a value opposite to the current direction. Then we clamp
-                 *    across zero so the car doesn’t start accelerating in the opposite direction
-                 *    just because slowdown overshot.
-                 *
-                 *  - car_max_speed caps the absolute value of speed so the car can’t accelerate
-                 *    forever.
-                 */
-                if(IsKeyDown(KEY_UP)){
-                    car_direction = -1; // Move forward
-                    car_speed += car_speedup * dt; // Accelerate
-                    if(car_speed > car_max_speed) car_speed = car_max_speed;
-                }
-                else if(IsKeyDown(KEY_DOWN)){
-                    car_direction = 1; // Move backward
-                    car_speed -= car_speedup * dt;
-                    if(car_speed > car_max_speed) car_speed = car_max_speed;
-                }
-                else {
-                    // Apply slowdown when no key pressed
-                    car_speed += car_slowdown * dt * car_direction;
-                    if(car_direction == -1 && car_speed < 0) car_speed = 0;
-                    else if(car_direction == 1 && car_speed > 0) car_speed = 0;
-                }                // Car rotation (turn left/right)
-                /**
-                 * ROTATION CONTROL
-                 * ----------------
-                 * Holding LEFT/RIGHT changes car_rotation by ROTATION_SPEED degrees per second.
-                 * We scale by dt so it turns at the same angular speed regardless of FPS.
-                 *
-                 * car_rotation is in DEGREES (0–360). Positive values rotate clockwise in Raylib's
-                 * screen coordinate system (Y grows downward). We normalize later to keep it within
-                 * [0, 360) which avoids numeric drift.
-                 */
-                if(IsKeyDown(KEY_LEFT))  car_rotation -= ROTATION_SPEED * dt;
-                else if(IsKeyDown(KEY_RIGHT)) car_rotation += ROTATION_SPEED * dt;                // Normalize rotation angle to [0, 360)
-                /**
-                 * ANGLE NORMALIZATION
-                 * -------------------
-                 * Keeping angles within a fixed range prevents overflow and simplifies logic.
-                 * Any value < 0 gets 360 added, any value ≥ 360 gets 360 subtracted.
-                 * This preserves direction while avoiding huge or negative angles.
-                 */
-                if (car_rotation >= 360) car_rotation -= 360;
-                if (car_rotation < 0) car_rotation += 360;                // Convert car rotation into movement vector
-                /**
-                 * FROM ANGLE + SPEED → X/Y VELOCITY
-                 * ---------------------------------
-                 * We must convert car_rotation (degrees) to radians for C’s trig functions.
-                 *
-                 *   radian = car_rotation * PI / 180
-                 *   x_move = car_speed * cos(radian)
-                 *   y_move = car_speed * sin(radian)
-                 *
-                 * Note on axes: In screen coords, +X is right, +Y is DOWN. Because your sprite
-                 * was rotated to face "up" and you use direction -1 for forward, the movement
-                 * appears natural (up means smaller Y). If you ever flip sprite orientation,
-                 * be ready to adjust the sign conventions here.
-                 */
-                float radian = car_rotation * PI / 180.0f;
-                float x_move = car_speed * cosf(radian);
-                float y_move = car_speed * sinf(radian);                // Move car but keep inside world bounds
-                /**
-                 * WORLD BOUNDARIES
-                 * ----------------
-                 * We compute tentative new_car_x/y, then only commit if the car remains inside
-                 * the world rectangle [0..world_width - car_width] × [0..world_height - car_height].
-                 * This prevents the camera/car from leaving the tile field.
-                 */
-                float new_car_x = car_x + x_move;
-                float new_car_y = car_y + y_move;
-                if (new_car_x >= 0 && new_car_x <= world_width - car_width) car_x = new_car_x;
-                if (new_car_y >= 0 && new_car_y <= world_height - car_height) car_y = new_car_y;                // ----------------------------
-                // CAMERA FOLLOWING
+                // FIXED-STEP SIMULATION
                 // ----------------------------
                 /**
-                 * CAMERA LERP WITH DEAD-ZONE
-                 * --------------------------
-                 * We point camera.target at the car but only move it when the car drifts farther
-                 * than `camera_threshold` from the current target (a dead-zone). This avoids a
-                 * jittery camera that constantly chases minor movements.
-                 *
-                 * Steps:
-                 *   1) Compute vector from current camera.target to car_center.
-                 *   2) If the distance exceeds camera_threshold, nudge camera.target toward the car
-                 *      by a small fraction each frame: target += delta * (lerp_speed * dt).
-                 *      This is exponential smoothing (a simple first-order low-pass filter).
-                 *   3) Clamp camera.target so that, with the current viewport size, the camera
-                 *      never shows space outside the world. We use half the screen size as margin.
-                 *
-                 * Tuning tips:
-                 *   - Increase threshold for a looser camera; decrease for a tighter follow.
-                 *   - Increase lerp_speed for snappier camera motion.
-                 */
-                Vector2 car_center = {car_x + car_width/2, car_y + car_height/2};
-                Vector2 screen_center = {camera.target.x, camera.target.y};
-                float distance_x = car_center.x - screen_center.x;
-                float distance_y = car_center.y - screen_center.y;
-                float total_distance = sqrt(distance_x * distance_x + distance_y * distance_y);
-
-                if (total_distance > camera_threshold) {
-                    float lerp_speed = 2.0f * dt; // smooth camera movement
-                    camera.target.x += distance_x * lerp_speed;
-                    camera.target.y += distance_y * lerp_speed;                // Clamp camera to world boundaries
-                /**
-                 * CAMERA CLAMPING
-                 * ---------------
-                 * camera.target represents the world-space point that will appear at the center
-                 * of the screen (because camera.offset = screen_center). To ensure the camera
-                 * never shows beyond the world edges, we clamp target so that the visible extents
-                 * (half-width/half-height around target) stay inside the world rect.
-                 */
-                    float camera_margin_x = width / 2;
-                    float camera_margin_y = height / 2;
-                    if (camera.target.x < camera_margin_x) camera.target.x = camera_margin_x;
-                    if (camera.target.x > world_width - camera_margin_x) camera.target.x = world_width - camera_margin_x;
-                    if (camera.target.y < camera_margin_y) camera.target.y = camera_margin_y;
-                    if (camera.target.y > world_height - camera_margin_y) camera.target.y = world_height - camera_margin_y;
-                }                // ESC -> return to MENU
-                /**
-                 * STATE SHORTCUT
-                 * --------------
-                 * Pressing ESC during gameplay switches back to MENU and resumes menu music.
-                 * Using IsKeyPressed ensures this triggers once per key press, not every frame
-                 * the key is held.
+                 * ACCUMULATOR
+                 * -----------
+                 * Frame time is banked in `sim_accumulator` and spent in whole SIM_DT ticks,
+                 * so the car covers the same ground per second at any frame rate. Whatever is
+                 * left over (less than one tick) becomes `sim_alpha`, used to blend the last
+                 * two ticks when drawing. The step count is capped so a long stall (window
+                 * drag, breakpoint) doesn't make the game try to catch up forever.
                  */
+                sim_input = 0;
+                if (IsKeyDown(KEY_UP)) sim_input |= SIM_INPUT_UP;
+                if (IsKeyDown(KEY_DOWN)) sim_input |= SIM_INPUT_DOWN;
+                if (IsKeyDown(KEY_LEFT)) sim_input |= SIM_INPUT_LEFT;
+                if (IsKeyDown(KEY_RIGHT)) sim_input |= SIM_INPUT_RIGHT;
+
+                sim_accumulator += dt;
+                int steps = 0;
+                while (sim_accumulator >= SIM_DT && steps < SIM_MAX_STEPS_PER_FRAME) {
+                    if (recording) replay_record_tick(&recorder, sim_input);
+                    if (online) net_client_tick(&net, &sim, sim_input); // Predicted; the server has the final say
+                    else sim_step(&sim, sim_input);
+                    if (!online) {
+                        // A finished lap becomes a ghost (saved, and raced against from now on);
+                        // every lap is recorded from the tick it started, so ghosts line up with the clock
+                        unsigned int lap_events = lap_timer_update(&lap_timer, &course, &sim);
+                        if ((lap_events & LAP_EVENT_FINISH) && lap_ghost_ok) {
+                            ghost_finish(&lap_ghost);
+                            ghost_save_lap(&lap_ghost, GHOST_DIR);
+                            ghost_count = ghost_keep(ghosts, ghost_count, GHOSTS_MAX, &lap_ghost);
+                            for (int i = 0; i < ghost_count; i++) ghost_cursors[i].tick = -1;
+                        }
+                        if (lap_events & (LAP_EVENT_START | LAP_EVENT_FINISH)) {
+                            ghost_free(&lap_ghost);
+                            ghost_begin(&lap_ghost, sim.world_width, sim.world_height);
+                            lap_ghost_ok = 1;
+                        }
+                        if (lap_ghost_ok && ghost_record(&lap_ghost, sim.vehicles.x[sim.focus], sim.vehicles.y[sim.focus],
+                                                         sim.vehicles.rotation[sim.focus]) != 0) {
+                            fprintf(stderr, "Not enough memory to record this lap's ghost\n");
+                            ghost_free(&lap_ghost);
+                            lap_ghost_ok = 0;
+                        }
+                    }
+                    sim_accumulator -= SIM_DT;
+                    steps++;
+                }
+                if (steps == SIM_MAX_STEPS_PER_FRAME && sim_accumulator >= SIM_DT) sim_accumulator = 0;
+                sim_alpha = sim_accumulator / SIM_DT;
+
+                // ESC -> return to MENU (see app_escape)
                 if (IsKeyPressed(KEY_ESCAPE)) {
-                    PlayMusicStream(menu_music);
-                    current_state = MENU;
+                    if (recording) replay_record_escape(&recorder);
+                    app_events |= app_escape(&app);
                 }
                 break;
         }
+        // Fold in the server's snapshots and send this frame's keys (in the menus too, as a heartbeat)
+        if (online && net_client_update(&net, &sim) != 0) {
+            fprintf(stderr, "Lost the connection to the server\n");
+            break;
+        }
+        prof_begin(PROF_AUDIO); // Only queues commands; the audio thread does the work
+        // Set before the click sound, so the arrow that changed the volume is heard at the new level
+        if (app_events & APP_EVENT_SOUND_CHANGED) audio_set_sound_volume(&audio, AUDIO_SFX_BUTTON, app.sound_volume / (float)APP_SOUND_STEPS);
+        if (app_events & APP_EVENT_BUTTON_SOUND) audio_play_sound(&audio, AUDIO_SFX_BUTTON);
+        if (app_events & APP_EVENT_MUSIC_GAME) {
+            audio_stop_music(&audio, AUDIO_TRACK_MENU);
+            audio_play_music(&audio, AUDIO_TRACK_GAME);
+        }
+        if (app_events & APP_EVENT_MUSIC_MENU) {
+            audio_stop_music(&audio, AUDIO_TRACK_GAME);
+            audio_play_music(&audio, AUDIO_TRACK_MENU);
+        }
+        prof_end(PROF_AUDIO);
+        if (app_events & APP_EVENT_PACING_CHANGED) apply_pacing(&pacer, &app);
+        if (app_events & (APP_EVENT_PACING_CHANGED | APP_EVENT_SOUND_CHANGED)) {
+            config.pacing_mode = app.pacing_mode;
+            config.target_fps = app.target_fps;
+            config.sound_volume = app.sound_volume;
+            if (config_save(&config, CONFIG_PATH) != 0) fprintf(stderr, "Could not save %s\n", CONFIG_PATH);
+        }
+        prof_end(PROF_INPUT);
+
+        // ----------------------------
+        // CHUNK STREAMING
+        // ----------------------------
+        // Queue what the camera will need and upload what the worker finished. Neither
+        // waits on the worker; a chunk that isn't ready yet is simply drawn as plain soil.
+        prof_begin(PROF_STREAM);
+        double stream_start = assets_clock();
+        if (app.state == GAME) {
+            SimRect stream_view = sim_visible_rect(&sim, sim.camera_x, sim.camera_y, camera.zoom);
+            float velocity_x = (sim.vehicles.x[sim.focus] - sim.vehicles.prev_x[sim.focus]) / SIM_DT;
+            float velocity_y = (sim.vehicles.y[sim.focus] - sim.vehicles.prev_y[sim.focus]) / SIM_DT;
+            world_update(&world, stream_view, velocity_x, velocity_y);
+        }
+        world_renderer_upload(&world_renderer);
+        long long stream_ns = (long long)((assets_clock() - stream_start) * 1e9);
+        prof_end(PROF_STREAM);
 
         // ----------------------------
         // DRAWING
         // ----------------------------
+        prof_begin(PROF_DRAW);
         BeginDrawing();
         ClearBackground(BACKGROUND_COLOR);
+        render_stats_reset();
 
-        switch(current_state) {
+        switch(app.state) {
             case MENU:
-                // Draw menu screen with buttons
-                DrawTexturePro(menu_background, (Rectangle){0, 0, menu_background.width, menu_background.height}, (Rectangle){0, 0, width, height}, (Vector2){0, 0}, 0, WHITE);
-                DrawText("Raceee", width/2 - MeasureText("Raceee", 80)/2, height/4, 80, BLACK);
-                Color play_color = CheckCollisionPointRec(mouse_pos, play_button) ? DARKGRAY : GRAY;
-                Color settings_color = CheckCollisionPointRec(mouse_pos, settings_button) ? DARKGRAY : GRAY;
-                DrawRectangleRec(play_button, play_color);
-                DrawRectangleLines(play_button.x, play_button.y, play_button.width, play_button.height, BLACK);
-                DrawText("PLAY", width/2 - MeasureText("PLAY", 30)/2, height/2 - 35, 30, WHITE);
-                DrawRectangleRec(settings_button, settings_color);
-                DrawRectangleLines(settings_button.x, settings_button.y, settings_button.width, settings_button.height, BLACK);
-                DrawText("SETTINGS", width/2 - MeasureText("SETTINGS", 30)/2, height/2 + 65, 30, WHITE);
+                // Menu screen with Play/Settings; only a button whose hover changed is redrawn
+                ui_screen_draw(&menu_screen, mouse_pos);
                 break;
 
             case SETTINGS:
-                // Draw settings screen with FPS adjustment
-                DrawTexturePro(menu_background, (Rectangle){0, 0, menu_background.width, menu_background.height}, (Rectangle){0, 0, width, height}, (Vector2){0, 0}, 0, WHITE);
-                DrawText("Settings", width/2 - MeasureText("Settings", 60)/2, height/4, 60, BLACK);
-                Color back_color = CheckCollisionPointRec(mouse_pos, back_button) ? DARKGRAY : GRAY;
-                DrawRectangleRec(back_button, back_color);
-                DrawRectangleLines(back_button.x, back_button.y, back_button.width, back_button.height, BLACK);
-                DrawText("BACK", 75, 65, 20, WHITE);
-                DrawText("FPS:", width/2 - 150, height/2 + 10, 30, BLACK);
-                DrawTexturePro(arrow_left,(Rectangle){0, 0, arrow_left.width, arrow_left.height}, fps_left_arrow, (Vector2){0, 0}, 0, WHITE);
-                DrawTexturePro(arrow_right,(Rectangle){0, 0, arrow_right.width, arrow_right.height}, fps_right_arrow, (Vector2){0, 0}, 0, WHITE);
-                char fps_text[10];
-                sprintf(fps_text, "%d", target_fps);
-                DrawText(fps_text, width/2 - MeasureText(fps_text, 30)/2, height/2 + 5, 30, BLACK);
+                // Settings screen with a frame rate and a pacing row
+                for (int row = 0; row < APP_SETTING_COUNT; row++) {
+                    int dimmed = row == APP_SETTING_FPS && app.pacing_mode != PACING_HYBRID; // Only hybrid pacing uses it
+                    ui_set_value(&settings_screen, setting_widgets[row], app_setting_get(&app, (AppSetting)row), dimmed);
+                }
+                if (GetTime() >= measured_refresh) { // Twice a second, readable and rarely redrawn
+                    PacingStats pacing_stats_now;
+                    pacing_stats(&pacer, &pacing_stats_now);
+                    ui_set_text(&settings_screen, measured_widget,
+                                TextFormat("Measured: %.1f FPS, jitter %.2f ms, input to present %.1f ms (p99 %.1f ms)",
+                                           pacing_stats_now.fps, pacing_stats_now.jitter_ms,
+                                           pacing_stats_now.latency_ms, pacing_stats_now.latency_p99_ms));
+                    measured_refresh = GetTime() + 0.5;
+                }
+                ui_screen_draw(&settings_screen, mouse_pos);
                 break;
 
             case GAME:
-                // Draw the world (tiles + car)
+                // Draw the world (tiles + cars) at the interpolated simulation state
+                sim_interpolate_camera(&sim, sim_alpha, &camera.target.x, &camera.target.y);
                 BeginMode2D(camera); // Enable camera mode
-                int tile_size = 512;
-                int start_tile_x = (int)((camera.target.x - width/2) / tile_size) - 1;
-                int start_tile_y = (int)((camera.target.y - height/2) / tile_size) - 1;
-                int end_tile_x = (int)((camera.target.x + width/2) / tile_size) + 1;
-                int end_tile_y = (int)((camera.target.y + height/2) / tile_size) + 1;
-                if (start_tile_x < 0) start_tile_x = 0;
-                if (start_tile_y < 0) start_tile_y = 0;
-                if (end_tile_x > world_width / tile_size) end_tile_x = world_width / tile_size;
-                if (end_tile_y > world_height / tile_size) end_tile_y = world_height / tile_size;
-                for(int x = start_tile_x; x <= end_tile_x; x++){
-                    for(int y = start_tile_y; y <= end_tile_y; y++){
-                        DrawTexture(soil_texture, x * tile_size, y * tile_size, WHITE);
-                    }
+                SimRect visible = sim_visible_rect(&sim, camera.target.x, camera.target.y, camera.zoom);
+                ground_draw(&ground, visible);
+                int missing_chunks = world_draw(&world_renderer, visible);
+                world_end_frame(&world, missing_chunks, stream_ns);
+                for (int i = 0; i < sim.obstacle_count; i++) {
+                    Obb box = sim.obstacles[i];
+                    float reach = box.half_width + box.half_height;
+                    if (box.x + reach < visible.x || box.x - reach > visible.x + visible.width ||
+                        box.y + reach < visible.y || box.y - reach > visible.y + visible.height) continue;
+                    Rectangle box_rec = {box.x, box.y, box.half_width * 2, box.half_height * 2};
+                    DrawRectanglePro(box_rec, (Vector2){box.half_width, box.half_height}, box.rotation, DARKBROWN);
+                    render_stats_count(1);
                 }
-                Rectangle car_rec = {.x = car_x,.y = car_y,.width = car_width,.height = car_height};
+                // Gates: the next one to pass stands out
+                for (int i = 0; i < LAP_GATE_COUNT && !online; i++) {
+                    if (course.x[i] + course.radius < visible.x || course.x[i] - course.radius > visible.x + visible.width ||
+                        course.y[i] + course.radius < visible.y || course.y[i] - course.radius > visible.y + visible.height) continue;
+                    Color gate_color = i == lap_timer.next_gate ? Fade(YELLOW, 0.8f) : Fade(WHITE, i == 0 ? 0.5f : 0.25f);
+                    DrawRing((Vector2){course.x[i], course.y[i]}, course.radius - 12, course.radius, 0, 360, 64, gate_color);
+                    render_stats_count(1);
+                }
+                // Ghosts at the same time into their lap as the player, under the traffic, in one batch
+                long lap_tick = lap_timer_current(&lap_timer, &sim);
+                int ghost_shown = 0;
+                for (int i = 0; i < ghost_count && show_ghosts && lap_timer.started; i++) {
+                    if (lap_tick >= ghosts[i].ticks) continue; // Already over the line
+                    ghost_advance(&ghosts[i], &ghost_cursors[i], lap_tick);
+                    GhostPose pose = ghost_pose(&ghost_cursors[i], sim_alpha);
+                    if (pose.x + car_width < visible.x || pose.x - car_width > visible.x + visible.width ||
+                        pose.y + car_width < visible.y || pose.y - car_width > visible.y + visible.height) continue;
+                    ghost_poses[ghost_shown++] = pose;
+                }
+                ghost_build_quads(ghost_poses, ghost_shown, car_width, car_height, ghost_quads);
+                ghost_draw(car_texture, ghost_quads, ghost_shown, Fade(SKYBLUE, 0.5f));
                 Vector2 car_origin = {.x = car_width / 2,.y = car_height / 2};
-                DrawTexturePro(car_texture, car_texture_rec, car_rec, car_origin, car_rotation, WHITE);
+                // Traffic first so the player is always drawn on top; skip cars off screen
+                for (int i = sim.vehicles.count - 1; i >= 0; i--) {
+                    SimCar car = sim_vehicle(&sim, i, sim_alpha);
+                    if (car.x + car_width < visible.x || car.x - car_width > visible.x + visible.width ||
+                        car.y + car_width < visible.y || car.y - car_width > visible.y + visible.height) continue;
+                    Rectangle car_rec = {.x = car.x,.y = car.y,.width = car_width,.height = car_height};
+                    int free_car = online && i < sim.player_count && !(net.active >> i & 1); // Slot nobody plays
+                    DrawTexturePro(car_texture, car_texture_rec, car_rec, car_origin, car.rotation, free_car ? Fade(WHITE, 0.4f) : WHITE);
+                    render_stats_count(1);
+                }
                 EndMode2D();
                 DrawText("Press ESC to return to menu", 10, 10, 20, WHITE);
+                DrawText(TextFormat("World draw calls: %d", render_stats.draw_calls), 10, 35, 20, WHITE);
+                DrawText(TextFormat("Contacts: %d", sim.contact_count), 10, 60, 20, WHITE);
+                DrawText(TextFormat("Chunks: %lu built, %lu evicted, %lu late frames",
+                                    world.stats.generated, world.stats.evicted, world.stats.missed_frames), 10, 85, 20, WHITE);
+                if (!online) {
+                    // Built up piece by piece: TextFormat hands out a small ring of buffers
+                    char lap_line[160];
+                    int used = snprintf(lap_line, sizeof lap_line, "Lap %d  %s", lap_timer.laps + 1,
+                                        lap_timer.started ? format_lap(lap_tick) : "-:--.--");
+                    if (lap_timer.last_lap) used += snprintf(lap_line + used, sizeof lap_line - used, "  last %s", format_lap(lap_timer.last_lap));
+                    if (lap_timer.best_lap) used += snprintf(lap_line + used, sizeof lap_line - used, "  best %s", format_lap(lap_timer.best_lap));
+                    if (ghost_count > 0) used += snprintf(lap_line + used, sizeof lap_line - used, "  ghost %s", format_lap(ghosts[0].ticks));
+                    DrawText(lap_line, 10, 110, 20, WHITE);
+                    DrawText(TextFormat("Ghosts: %d of %d shown%s (F5)", ghost_shown, ghost_count, show_ghosts ? "" : ", hidden"),
+                             10, 135, 20, WHITE);
+                }
                 break;
         }
 
-        EndDrawing(); // End frame rendering
+        if (profiler.overlay) profiler_draw_overlay(10, height - 140);
+        if (online && net_panel && app.state == GAME) draw_net_stats(&net, width - 480, 15);
+        prof_end(PROF_DRAW);
+
+        prof_begin(PROF_PRESENT);
+        pacing_wait(&pacer); // Hybrid pacing: sleep, then spin to this frame's deadline
+        EndDrawing(); // End frame rendering (swap buffers; blocks for the refresh with VSync)
+        pacing_presented(&pacer);
+        prof_end(PROF_PRESENT);
+        profiler_frame_end();
     }
 
     // ----------------------------
-    // CLEANUP (unload resources)
+    // CLEANUP (unload resources, newest first; a failed setup step jumps in at its label)
     // ----------------------------
-    UnloadTexture(menu_background);
-    UnloadTexture(arrow_left);
-    UnloadTexture(arrow_right);
-    UnloadSound(button_sound);
-    UnloadMusicStream(menu_music);
-    UnloadImage(car_image);
-    UnloadTexture(car_texture);
-    UnloadTexture(soil_texture);
-    UnloadImage(soil_image);
+    if (recording && replay_record_end(&recorder, &sim, &app) == 0) printf("Replay saved to %s\n", record_path);
+    printf("Chunk streaming: %lu of %lu game frames late (%lu chunks shown before they were ready), "
+           "worst streaming work %.2f ms, %lu built, %lu evicted, %d slots in %zu MB\n",
+           world.stats.missed_frames, world.stats.frames, world.stats.missing_chunks, world.stats.worst_stream_ns / 1e6,
+           world.stats.generated, world.stats.evicted, world.slot_count, world.memory_bytes >> 20);
+    for (int i = 0; i < ghost_count; i++) ghost_free(&ghosts[i]);
+    ghost_free(&lap_ghost);
+    world_renderer_free(&world_renderer);
+free_world:
+    world_free(&world);
+free_sim:
+    sim_free(&sim);
+close_net:
+    if (online) net_client_close(&net); // Frees our slot right away instead of after the timeout
+free_screens:
+    ui_screen_free(&menu_screen);
+    ui_screen_free(&settings_screen);
+    audio_stop(&audio);     // Before the sounds and music it plays are unloaded
+unload_assets:
+    assets_unload(&assets); // Textures, sounds and music
+    jobs_shutdown();        // After the chunk streamer, which posts jobs
+    profiler_close();
     CloseAudioDevice();
     CloseWindow();
-    return 0;
+    return exit_code;
 }
 
 // Credits: Back/Next icons from Flaticon
@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200112L
+#include "net.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+long long net_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct sockaddr_in to_sockaddr(NetAddress address){
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = address.host;
+    addr.sin_port = address.port;
+    return addr;
+}
+
+int net_open(NetSocket *net, int port, const NetConditions *conditions){
+    memset(net, 0, sizeof *net);
+    if (conditions) net->conditions = *conditions;
+    net->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (net->fd < 0) {
+        fprintf(stderr, "net: could not create a socket: %s\n", strerror(errno));
+        return -1;
+    }
+    NetAddress any = {htonl(INADDR_ANY), htons((unsigned short)port)};
+    struct sockaddr_in addr = to_sockaddr(any);
+    if (bind(net->fd, (struct sockaddr *)&addr, sizeof addr) != 0 ||
+        fcntl(net->fd, F_SETFL, fcntl(net->fd, F_GETFL) | O_NONBLOCK) != 0) {
+        fprintf(stderr, "net: could not open UDP port %d: %s\n", port, strerror(errno));
+        close(net->fd);
+        net->fd = -1;
+        return -1;
+    }
+    if (net->conditions.lag_ms > 0 || net->conditions.loss_percent > 0) {
+        net->outgoing.slots = malloc(sizeof(NetDelayed) * NET_DELAY_SLOTS);
+        net->incoming.slots = malloc(sizeof(NetDelayed) * NET_DELAY_SLOTS);
+        if (!net->outgoing.slots || !net->incoming.slots) {
+            fprintf(stderr, "net: out of memory for the lag queues\n");
+            net_close(net);
+            return -1;
+        }
+    }
+    net->rng = 0x9e3779b9u ^ (unsigned int)port;
+    return 0;
+}
+
+void net_close(NetSocket *net){
+    if (net->fd >= 0) close(net->fd);
+    net->fd = -1;
+    free(net->outgoing.slots);
+    free(net->incoming.slots);
+    net->outgoing.slots = net->incoming.slots = NULL;
+}
+
+int net_resolve(NetAddress *address, const char *host, int port){
+    struct in_addr in;
+    if (strcmp(host, "localhost") == 0) host = "127.0.0.1";
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, host, &in) != 1) {
+        fprintf(stderr, "net: %s:%d is not an IPv4 address and port\n", host, port);
+        return -1;
+    }
+    address->host = in.s_addr;
+    address->port = htons((unsigned short)port);
+    return 0;
+}
+
+int net_same_address(NetAddress a, NetAddress b){
+    return a.host == b.host && a.port == b.port;
+}
+
+// ----------------------------
+// LAG AND LOSS
+// ----------------------------
+/**
+ * INJECTED CONDITIONS
+ * -------------------
+ * Each direction has its own FIFO: a packet is either dropped (loss_percent out
+ * of 100, from a per-socket LCG) or parked with a due time half the lag away.
+ * Outgoing packets leave on net_flush(), incoming ones are handed to the game by
+ * net_receive() once due. With a clean link both queues are skipped entirely.
+ * When a queue is full the packet goes through undelayed rather than vanish.
+ */
+static int lost(NetSocket *net){
+    if (net->conditions.loss_percent <= 0) return 0;
+    net->rng = net->rng * 1664525u + 1013904223u;
+    return (int)((net->rng >> 8) % 100) < net->conditions.loss_percent;
+}
+
+static NetDelayed *delay_push(NetSocket *net, NetDelayQueue *queue){
+    if (!queue->slots || queue->count == NET_DELAY_SLOTS) return NULL;
+    NetDelayed *slot = &queue->slots[(queue->head + queue->count++) % NET_DELAY_SLOTS];
+    slot->due_ns = net_now_ns() + (long long)net->conditions.lag_ms * 1000000LL / 2;
+    return slot;
+}
+
+static NetDelayed *delay_due(NetDelayQueue *queue, long long now){
+    if (queue->count == 0 || queue->slots[queue->head].due_ns > now) return NULL;
+    NetDelayed *slot = &queue->slots[queue->head];
+    queue->head = (queue->head + 1) % NET_DELAY_SLOTS;
+    queue->count--;
+    return slot;   // Stays valid until the next push
+}
+
+static int send_now(NetSocket *net, NetAddress to, const void *data, int size){
+    struct sockaddr_in addr = to_sockaddr(to);
+    if (sendto(net->fd, data, size, 0, (struct sockaddr *)&addr, sizeof addr) != size) return -1;
+    net->bytes_sent += size;
+    net->packets_sent++;
+    return 0;
+}
+
+int net_send(NetSocket *net, NetAddress to, const void *data, int size){
+    if (size > NET_MAX_PACKET) return -1;
+    net_flush(net);   // Keep the order: older held-back packets go first
+    if (lost(net)) {
+        net->packets_dropped++;
+        return 0;
+    }
+    NetDelayed *slot = delay_push(net, &net->outgoing);
+    if (!slot) return send_now(net, to, data, size);
+    slot->address = to;
+    slot->size = size;
+    memcpy(slot->data, data, size);
+    return 0;
+}
+
+void net_flush(NetSocket *net){
+    long long now = net_now_ns();
+    NetDelayed *slot;
+    while ((slot = delay_due(&net->outgoing, now))) send_now(net, slot->address, slot->data, slot->size);
+}
+
+int net_receive(NetSocket *net, NetAddress *from, void *buffer, int capacity){
+    net_flush(net);
+    for (;;) {
+        unsigned char packet[NET_MAX_PACKET];
+        struct sockaddr_in addr;
+        socklen_t length = sizeof addr;
+        int size = (int)recvfrom(net->fd, packet, sizeof packet, 0, (struct sockaddr *)&addr, &length);
+        if (size <= 0) break;   // EAGAIN: nothing more has arrived
+        net->bytes_received += size;
+        net->packets_received++;
+        NetAddress sender = {addr.sin_addr.s_addr, addr.sin_port};
+        if (lost(net)) {
+            net->packets_dropped++;
+            continue;
+        }
+        NetDelayed *slot = delay_push(net, &net->incoming);
+        if (!slot) {
+            // Clean link (or a full queue): hand it over right away
+            if (size > capacity) continue;
+            memcpy(buffer, packet, size);
+            *from = sender;
+            return size;
+        }
+        slot->address = sender;
+        slot->size = size;
+        memcpy(slot->data, packet, size);
+    }
+    NetDelayed *slot = delay_due(&net->incoming, net_now_ns());
+    if (!slot || slot->size > capacity) return 0;
+    memcpy(buffer, slot->data, slot->size);
+    *from = slot->address;
+    return slot->size;
+}
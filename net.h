@@ -0,0 +1,71 @@
+#ifndef NET_H
+#define NET_H
+
+// ----------------------------
+// UDP SOCKETS
+// ----------------------------
+// Non-blocking IPv4 datagrams for the multiplayer mode. A socket can also make the
+// network worse on purpose: every packet it sends or receives can be held back
+// and dropped at random, so two games on 127.0.0.1 behave like players far apart.
+
+#define NET_MAX_PACKET 1200     // Bytes; every message of the game fits in one datagram
+#define NET_DELAY_SLOTS 512     // Packets that can be held back in each direction
+
+typedef struct {
+    unsigned int host;          // IPv4 address, network byte order
+    unsigned short port;        // Network byte order
+} NetAddress;
+
+// Artificial network conditions, applied both ways
+typedef struct {
+    int lag_ms;                 // Added to the round trip, half on the way out and half on the way in
+    int loss_percent;           // Chance that a packet is dropped, in each direction
+} NetConditions;
+
+typedef struct {
+    long long due_ns;           // When the packet may leave (or be handed to the game)
+    NetAddress address;
+    int size;
+    unsigned char data[NET_MAX_PACKET];
+} NetDelayed;
+
+// FIFO of held-back packets; the lag is fixed, so due times only grow
+typedef struct {
+    NetDelayed *slots;
+    int head, count;
+} NetDelayQueue;
+
+typedef struct {
+    int fd;
+    NetConditions conditions;
+    unsigned int rng;           // Decides which packets are lost
+    NetDelayQueue outgoing, incoming;
+    unsigned long bytes_sent, bytes_received;        // What actually crossed the socket
+    unsigned long packets_sent, packets_received;
+    unsigned long packets_dropped;                   // By the loss injection, both ways
+} NetSocket;
+
+// Monotonic clock shared by everything network-related
+long long net_now_ns(void);
+
+// Binds a UDP socket to `port` on every interface (0 = any free port). `conditions`
+// may be NULL for a clean link. Returns 0 on success, -1 with a message on stderr.
+int net_open(NetSocket *net, int port, const NetConditions *conditions);
+
+void net_close(NetSocket *net);
+
+// Fills `address` from a dotted IPv4 host (or "localhost") and a port; 0 or -1
+int net_resolve(NetAddress *address, const char *host, int port);
+
+int net_same_address(NetAddress a, NetAddress b);
+
+// Queues or sends one datagram; returns 0, or -1 if it is too big or the send failed
+int net_send(NetSocket *net, NetAddress to, const void *data, int size);
+
+// Next datagram that has arrived (and served its delay); returns its size, or 0 if none
+int net_receive(NetSocket *net, NetAddress *from, void *buffer, int capacity);
+
+// Sends held-back packets whose time has come; call at least once per frame
+void net_flush(NetSocket *net);
+
+#endif
@@ -0,0 +1,616 @@
+#define _POSIX_C_SOURCE 200112L
+#include "netplay.h"
+#include <arpa/inet.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NET_MAGIC 0x31504e52u   // "RNP1"; a hello with anything else is ignored
+#define HELLO_RETRY_NS 250000000LL
+#define INPUT_HEARTBEAT_NS 100000000LL   // Send an (empty) input packet at least this often
+
+typedef enum {
+    NET_MSG_HELLO = 1,      // client → server: u32 magic
+    NET_MSG_WELCOME,        // server → client: u8 slot, u8 slots, u32 world width, u32 world height
+    NET_MSG_FULL,           // server → client: no free slot
+    NET_MSG_INPUT,          // client → server: u32 acked tick, u32 last seq, u8 count, count × u8 keys (oldest first)
+    NET_MSG_SNAPSHOT,       // server → client: see net_write_snapshot()
+    NET_MSG_BYE,            // client → server: leaving
+} NetMessage;
+
+// ----------------------------
+// ENCODING
+// ----------------------------
+static unsigned char *put_u32(unsigned char *p, unsigned int value){
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    return p + 4;
+}
+
+static unsigned int get_u32(const unsigned char *p){
+    return p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+// Small differences of either sign become small unsigned numbers: 0, -1, 1, -2 → 0, 1, 2, 3
+static unsigned char *put_delta(unsigned char *p, int delta){
+    unsigned int value = ((unsigned int)delta << 1) ^ (unsigned int)(delta >> 31);
+    while (value >= 0x80) {
+        *p++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (unsigned char)value;
+    return p;
+}
+
+static const unsigned char *get_delta(const unsigned char *p, const unsigned char *end, int *delta){
+    unsigned int value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p == end) return NULL;
+        unsigned char byte = *p++;
+        value |= (unsigned int)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *delta = (int)(value >> 1) ^ -(int)(value & 1);
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static int history_slot(unsigned int tick){
+    return (int)(tick / NET_SNAPSHOT_INTERVAL % NET_SNAPSHOT_HISTORY);
+}
+
+enum { FIELD_X = 1, FIELD_Y = 2, FIELD_ROTATION = 4, FIELD_SPEED = 8, FIELD_FLAGS = 16 };
+#define SNAPSHOT_HEADER 15
+
+int net_write_snapshot(unsigned char *out, const NetSnapshot *snapshot, const NetSnapshot *baseline, unsigned int input_seq){
+    static const NetSnapshot nothing;   // Full snapshots are deltas from all zeroes
+    const NetSnapshot *base = baseline ? baseline : &nothing;
+    unsigned char *p = out;
+    *p++ = NET_MSG_SNAPSHOT;
+    p = put_u32(p, snapshot->tick);
+    p = put_u32(p, baseline ? baseline->tick : 0);
+    p = put_u32(p, input_seq);
+    *p++ = snapshot->active;
+    unsigned char *car_mask = p++;
+    *car_mask = 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        const NetCar *car = &snapshot->cars[i], *old = &base->cars[i];
+        int fields = (car->x != old->x ? FIELD_X : 0) | (car->y != old->y ? FIELD_Y : 0) |
+                     (car->rotation != old->rotation ? FIELD_ROTATION : 0) |
+                     (car->speed != old->speed ? FIELD_SPEED : 0) | (car->flags != old->flags ? FIELD_FLAGS : 0);
+        if (!fields) continue;
+        *car_mask |= 1 << i;
+        *p++ = (unsigned char)fields;
+        if (fields & FIELD_X) p = put_delta(p, car->x - old->x);
+        if (fields & FIELD_Y) p = put_delta(p, car->y - old->y);
+        if (fields & FIELD_ROTATION) p = put_delta(p, (short)(car->rotation - old->rotation));   // Shortest way round
+        if (fields & FIELD_SPEED) p = put_delta(p, car->speed - old->speed);
+        if (fields & FIELD_FLAGS) *p++ = car->flags;
+    }
+    return (int)(p - out);
+}
+
+int net_read_snapshot(const unsigned char *data, int size, const NetSnapshot *baselines,
+                      NetSnapshot *snapshot, unsigned int *input_seq){
+    if (size < SNAPSHOT_HEADER || data[0] != NET_MSG_SNAPSHOT) return -1;
+    const unsigned char *p = data + 1, *end = data + size;
+    unsigned int tick = get_u32(p);
+    unsigned int base_tick = get_u32(p + 4);
+    *input_seq = get_u32(p + 8);
+    p += 12;
+    if (base_tick) {
+        const NetSnapshot *base = &baselines[history_slot(base_tick)];
+        if (base->tick != base_tick) return -1;
+        *snapshot = *base;
+    } else {
+        memset(snapshot, 0, sizeof *snapshot);
+    }
+    snapshot->tick = tick;
+    snapshot->active = *p++;
+    unsigned char car_mask = *p++;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (!(car_mask & 1 << i)) continue;
+        if (p == end) return -1;
+        NetCar *car = &snapshot->cars[i];
+        int fields = *p++, delta;
+        if ((fields & FIELD_X) && (p = get_delta(p, end, &delta))) car->x += delta;
+        if (p && (fields & FIELD_Y) && (p = get_delta(p, end, &delta))) car->y += delta;
+        if (p && (fields & FIELD_ROTATION) && (p = get_delta(p, end, &delta))) car->rotation += delta;
+        if (p && (fields & FIELD_SPEED) && (p = get_delta(p, end, &delta))) car->speed += delta;
+        if (p && (fields & FIELD_FLAGS)) {
+            if (p == end) return -1;
+            car->flags = *p++;
+        }
+        if (!p) return -1;
+    }
+    return 0;
+}
+
+// ----------------------------
+// QUANTIZATION
+// ----------------------------
+NetCar net_car_pack(const VehicleStore *vehicles, int index, unsigned int input){
+    NetCar car;
+    car.x = (int)lroundf(vehicles->x[index] * 8);
+    car.y = (int)lroundf(vehicles->y[index] * 8);
+    car.rotation = (unsigned short)(lroundf(vehicles->rotation[index] * 8192.0f / 45.0f) & 0xffff);   // 65536 / 360
+    car.speed = (short)lroundf(vehicles->speed[index] * 64);
+    car.flags = (unsigned char)((input & 0x0f) | (vehicles->direction[index] > 0 ? NET_FLAG_REVERSE : 0));
+    return car;
+}
+
+// Every value is a small integer over a power of two (or times 45), so it is exact as a float
+void net_car_unpack(VehicleStore *vehicles, int index, NetCar car){
+    vehicles->x[index] = car.x / 8.0f;
+    vehicles->y[index] = car.y / 8.0f;
+    vehicles->rotation[index] = (float)(car.rotation * 45) / 8192.0f;
+    vehicles->speed[index] = car.speed / 64.0f;
+    vehicles->direction[index] = car.flags & NET_FLAG_REVERSE ? 1.0f : -1.0f;
+    vehicles->throttle[index] = (car.flags & SIM_INPUT_UP) ? 1.0f : (car.flags & SIM_INPUT_DOWN) ? -1.0f : 0.0f;
+    vehicles->steer[index] = (car.flags & SIM_INPUT_LEFT) ? -1.0f : (car.flags & SIM_INPUT_RIGHT) ? 1.0f : 0.0f;
+}
+
+static void quantize_players(SimState *sim, const unsigned int *inputs){
+    for (int i = 0; i < sim->player_count; i++) {
+        net_car_unpack(&sim->vehicles, i, net_car_pack(&sim->vehicles, i, inputs[i]));
+    }
+}
+
+static void sleep_ns(long long ns){
+    if (ns <= 0) return;
+    struct timespec ts = {ns / 1000000000LL, ns % 1000000000LL};
+    nanosleep(&ts, NULL);
+}
+
+static const char *address_text(NetAddress address){
+    static char text[32];
+    struct in_addr in = {address.host};
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in, host, sizeof host);
+    snprintf(text, sizeof text, "%s:%d", host, ntohs(address.port));
+    return text;
+}
+
+// ----------------------------
+// SERVER
+// ----------------------------
+void net_server_default_options(NetServerOptions *options){
+    options->port = NET_DEFAULT_PORT;
+    options->seconds = 0;
+    options->world_size = SIM_WORLD_WIDTH;
+    options->conditions = (NetConditions){0, 0};
+    options->verbose = 1;
+}
+
+void net_server_parse_args(NetServerOptions *options, int argc, char **argv){
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--port") == 0) options->port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--server-seconds") == 0) options->seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--world-size") == 0) options->world_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--net-lag") == 0) options->conditions.lag_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--net-loss") == 0) options->conditions.loss_percent = atoi(argv[++i]);
+    }
+    if (options->world_size < NET_VIEW_WIDTH) options->world_size = NET_VIEW_WIDTH;
+}
+
+int net_server_init(NetServer *server, const NetServerOptions *options){
+    memset(server, 0, sizeof *server);
+    server->verbose = options->verbose;
+    if (net_open(&server->socket, options->port, &options->conditions) != 0) return -1;
+    // Every slot has its car from the start; nobody drives the empty ones
+    if (sim_init_players(&server->sim, options->world_size, options->world_size, NET_VIEW_WIDTH, NET_VIEW_HEIGHT,
+                         NET_CAR_WIDTH, NET_CAR_HEIGHT, NET_MAX_PLAYERS, 0) != 0) {
+        fprintf(stderr, "server: could not allocate the world\n");
+        net_close(&server->socket);
+        return -1;
+    }
+    unsigned int none[NET_MAX_PLAYERS] = {0};
+    quantize_players(&server->sim, none);
+    return 0;
+}
+
+void net_server_free(NetServer *server){
+    sim_free(&server->sim);
+    net_close(&server->socket);
+}
+
+static void server_send(NetServer *server, NetPeer *peer, const unsigned char *data, int size){
+    net_send(&server->socket, peer->address, data, size);
+    peer->bytes_out += size;
+}
+
+// Slot of the connected client at `from`, or -1
+static int find_peer(const NetServer *server, NetAddress from){
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (server->peers[i].connected && net_same_address(server->peers[i].address, from)) return i;
+    }
+    return -1;
+}
+
+static void server_hello(NetServer *server, NetAddress from){
+    int slot = find_peer(server, from);
+    int joined = slot < 0;
+    for (int i = 0; i < NET_MAX_PLAYERS && slot < 0; i++) {
+        if (!server->peers[i].connected) slot = i;
+    }
+    if (slot < 0) {
+        unsigned char full = NET_MSG_FULL;
+        net_send(&server->socket, from, &full, 1);
+        return;
+    }
+    NetPeer *peer = &server->peers[slot];
+    if (joined) {
+        memset(peer, 0, sizeof *peer);
+        peer->connected = 1;
+        peer->address = from;
+        peer->last_heard_ns = net_now_ns();
+        if (server->verbose) printf("server: player %d joined from %s\n", slot, address_text(from));
+    }
+    // Sent again for every hello, in case the first welcome was lost
+    unsigned char welcome[11], *p = welcome;
+    *p++ = NET_MSG_WELCOME;
+    *p++ = (unsigned char)slot;
+    *p++ = NET_MAX_PLAYERS;
+    p = put_u32(p, (unsigned int)server->sim.world_width);
+    p = put_u32(p, (unsigned int)server->sim.world_height);
+    server_send(server, peer, welcome, (int)(p - welcome));
+}
+
+/**
+ * INPUT PACKETS
+ * -------------
+ * A client resends every input the server has not acknowledged yet, so a lost
+ * packet costs nothing as long as a later one arrives. Only inputs newer than
+ * what has already arrived are stored; the newest acknowledged snapshot comes
+ * along and becomes the baseline for this client's next delta.
+ */
+static void server_input(NetServer *server, NetPeer *peer, const unsigned char *data, int size){
+    if (size < 10) return;
+    unsigned int acked = get_u32(data + 1);
+    unsigned int last = get_u32(data + 5);
+    int count = data[9];
+    if (size < 10 + count) return;
+    if (acked > peer->acked_tick && acked <= server->tick) peer->acked_tick = acked;
+    for (int k = 0; k < count; k++) {
+        unsigned int seq = last - (unsigned int)(count - 1 - k);
+        if (seq <= peer->received_seq || seq <= peer->applied_seq) continue;
+        peer->inputs[seq % NET_INPUT_HISTORY] = data[10 + k];
+    }
+    if (last > peer->received_seq) peer->received_seq = last;
+}
+
+static void server_receive(NetServer *server){
+    unsigned char data[NET_MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = net_receive(&server->socket, &from, data, sizeof data)) > 0) {
+        if (data[0] == NET_MSG_HELLO) {
+            if (size >= 5 && get_u32(data + 1) == NET_MAGIC) server_hello(server, from);
+            continue;
+        }
+        int slot = find_peer(server, from);
+        if (slot < 0) continue;   // A stranger, or someone who already timed out
+        NetPeer *peer = &server->peers[slot];
+        peer->last_heard_ns = net_now_ns();
+        peer->bytes_in += size;
+        if (data[0] == NET_MSG_INPUT) server_input(server, peer, data, size);
+        if (data[0] == NET_MSG_BYE) {
+            peer->connected = 0;
+            if (server->verbose) printf("server: player %d left\n", slot);
+        }
+    }
+}
+
+/**
+ * ONE INPUT PER TICK
+ * ------------------
+ * Each client's inputs are numbered and the server applies exactly one per tick,
+ * in order, which is what the client predicted. If none has arrived the last
+ * keys are held for NET_INPUT_REPEAT ticks (a late packet, most likely), then
+ * released so a client that stopped sending coasts to a stop. A client more than
+ * NET_INPUT_BACKLOG inputs ahead (after a stall) has the oldest ones dropped,
+ * which keeps its latency bounded; its prediction is corrected afterwards.
+ */
+static unsigned int next_input(NetPeer *peer){
+    if (peer->received_seq - peer->applied_seq > NET_INPUT_BACKLOG) {
+        unsigned int target = peer->received_seq - NET_INPUT_BACKLOG / 2;
+        peer->skipped_inputs += target - peer->applied_seq;
+        peer->applied_seq = target;
+    }
+    if (peer->applied_seq < peer->received_seq) {
+        peer->applied_seq++;
+        peer->input = peer->inputs[peer->applied_seq % NET_INPUT_HISTORY];
+        peer->starved = 0;
+    } else if (++peer->starved > NET_INPUT_REPEAT) {
+        peer->input = 0;
+    }
+    return peer->input;
+}
+
+void net_server_tick(NetServer *server){
+    server_receive(server);
+    long long now = net_now_ns();
+    unsigned int inputs[NET_MAX_PLAYERS] = {0};
+    unsigned char active = 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        NetPeer *peer = &server->peers[i];
+        if (peer->connected && now - peer->last_heard_ns > NET_TIMEOUT_NS) {
+            peer->connected = 0;
+            if (server->verbose) printf("server: player %d timed out\n", i);
+        }
+        if (!peer->connected) continue;
+        inputs[i] = next_input(peer);
+        active |= 1 << i;
+    }
+    sim_step_players(&server->sim, inputs);
+    quantize_players(&server->sim, inputs);
+    server->tick++;
+
+    if (server->tick % NET_SNAPSHOT_INTERVAL == 0) {
+        NetSnapshot snapshot;
+        memset(&snapshot, 0, sizeof snapshot);
+        snapshot.tick = server->tick;
+        snapshot.active = active;
+        for (int i = 0; i < NET_MAX_PLAYERS; i++) snapshot.cars[i] = net_car_pack(&server->sim.vehicles, i, inputs[i]);
+        for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+            NetPeer *peer = &server->peers[i];
+            if (!peer->connected) continue;
+            const NetSnapshot *baseline = &server->history[history_slot(peer->acked_tick)];
+            if (peer->acked_tick == 0 || baseline->tick != peer->acked_tick) baseline = NULL;
+            unsigned char packet[NET_MAX_PACKET];
+            server_send(server, peer, packet, net_write_snapshot(packet, &snapshot, baseline, peer->applied_seq));
+            peer->snapshots++;
+            if (!baseline) peer->full_snapshots++;
+        }
+        server->history[history_slot(server->tick)] = snapshot;
+    }
+    net_flush(&server->socket);
+}
+
+int net_server_run(const NetServerOptions *options){
+    static NetServer server;   // Input and snapshot rings: too big for the stack
+    if (net_server_init(&server, options) != 0) return 1;
+    if (server.verbose) {
+        printf("server: listening on UDP port %d, %d slots, world %dx%d", options->port, NET_MAX_PLAYERS,
+               server.sim.world_width, server.sim.world_height);
+        if (options->conditions.lag_ms || options->conditions.loss_percent) {
+            printf(", adding %d ms lag and %d%% loss", options->conditions.lag_ms, options->conditions.loss_percent);
+        }
+        printf("\n");
+    }
+    const long long tick_ns = 1000000000LL / SIM_TICK_RATE;
+    long long start = net_now_ns(), next = start, report = start + 1000000000LL;
+    unsigned long last_out[NET_MAX_PLAYERS] = {0}, last_in[NET_MAX_PLAYERS] = {0};
+    while (options->seconds <= 0 || net_now_ns() - start < options->seconds * 1000000000LL) {
+        net_server_tick(&server);
+        next += tick_ns;
+        long long now = net_now_ns();
+        if (now - next > SIM_MAX_STEPS_PER_FRAME * tick_ns) next = now;   // Stalled: don't try to catch up
+        if (server.verbose && now >= report) {
+            for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+                NetPeer *peer = &server.peers[i];
+                if (!peer->connected) continue;
+                printf("server: player %d  down %.1f KB/s  up %.1f KB/s  %lu snapshots (%lu full)  backlog %u  skipped %lu\n",
+                       i, (peer->bytes_out - last_out[i]) / 1024.0, (peer->bytes_in - last_in[i]) / 1024.0,
+                       peer->snapshots, peer->full_snapshots, peer->received_seq - peer->applied_seq, peer->skipped_inputs);
+                last_out[i] = peer->bytes_out;
+                last_in[i] = peer->bytes_in;
+            }
+            fflush(stdout);
+            report += 1000000000LL;
+        }
+        sleep_ns(next - net_now_ns());
+    }
+    net_server_free(&server);
+    return 0;
+}
+
+// ----------------------------
+// CLIENT
+// ----------------------------
+int net_client_connect(NetClient *client, const char *host, int port, const NetConditions *conditions, int timeout_ms){
+    memset(client, 0, sizeof *client);
+    if (net_resolve(&client->server, host, port) != 0) return -1;
+    if (net_open(&client->socket, 0, conditions) != 0) return -1;
+    long long start = net_now_ns(), next_hello = start;
+    while (net_now_ns() - start < timeout_ms * 1000000LL) {
+        if (net_now_ns() >= next_hello) {
+            unsigned char hello[5];
+            hello[0] = NET_MSG_HELLO;
+            put_u32(hello + 1, NET_MAGIC);
+            net_send(&client->socket, client->server, hello, sizeof hello);
+            next_hello += HELLO_RETRY_NS;
+        }
+        unsigned char data[NET_MAX_PACKET];
+        NetAddress from;
+        int size;
+        while ((size = net_receive(&client->socket, &from, data, sizeof data)) > 0) {
+            if (!net_same_address(from, client->server)) continue;
+            if (data[0] == NET_MSG_FULL) {
+                fprintf(stderr, "net: %s:%d has no free slot\n", host, port);
+                net_close(&client->socket);
+                return -1;
+            }
+            if (data[0] != NET_MSG_WELCOME || size < 11) continue;
+            if (data[2] != NET_MAX_PLAYERS) {
+                fprintf(stderr, "net: %s:%d runs a different version (%d slots)\n", host, port, data[2]);
+                net_close(&client->socket);
+                return -1;
+            }
+            client->id = data[1];
+            client->world_width = (int)get_u32(data + 3);
+            client->world_height = (int)get_u32(data + 7);
+            client->last_heard_ns = client->rate_start_ns = net_now_ns();
+            return 0;
+        }
+        sleep_ns(2000000);
+    }
+    fprintf(stderr, "net: no answer from %s:%d\n", host, port);
+    net_close(&client->socket);
+    return -1;
+}
+
+int net_client_init_sim(NetClient *client, SimState *sim, int view_width, int view_height){
+    if (sim_init_players(sim, client->world_width, client->world_height, view_width, view_height,
+                         NET_CAR_WIDTH, NET_CAR_HEIGHT, NET_MAX_PLAYERS, 0) != 0) return -1;
+    unsigned int none[NET_MAX_PLAYERS] = {0};
+    quantize_players(sim, none);
+    sim->focus = client->id;
+    sim->camera_x = sim->prev_camera_x = sim->vehicles.x[client->id] + sim->car_width/2;
+    sim->camera_y = sim->prev_camera_y = sim->vehicles.y[client->id] + sim->car_height/2;
+    return 0;
+}
+
+// Our keys for `seq`, everyone else's as of the latest snapshot
+static void predict(NetClient *client, SimState *sim, unsigned int seq){
+    unsigned int inputs[NET_MAX_PLAYERS];
+    memcpy(inputs, client->remote_inputs, sizeof inputs);
+    inputs[client->id] = client->inputs[seq % NET_INPUT_HISTORY];
+    sim_step_players(sim, inputs);
+    quantize_players(sim, inputs);
+}
+
+void net_client_tick(NetClient *client, SimState *sim, unsigned int input){
+    client->seq++;
+    client->inputs[client->seq % NET_INPUT_HISTORY] = input;
+    client->input_sent_ns[client->seq % NET_INPUT_HISTORY] = 0;
+    predict(client, sim, client->seq);
+}
+
+/**
+ * RECONCILIATION
+ * --------------
+ * A snapshot is the world as it was when the server applied input `input_seq`.
+ * Every player car is reset to it, then our inputs the server had not applied
+ * yet are replayed on top, which brings our car back to the present along the
+ * server's history. With the same inputs and the same quantization the result
+ * is bit-identical to the prediction and nothing moves; the distance it does
+ * move is the correction. Other players are carried forward the same number
+ * of ticks on the keys they were holding. The camera, tick counter and the
+ * previous-tick positions used for drawing are put back afterwards, so a
+ * correction blends in over the frame instead of jumping.
+ */
+static void reconcile(NetClient *client, SimState *sim, const NetSnapshot *snapshot, unsigned int input_seq){
+    VehicleStore *vehicles = &sim->vehicles;
+    int me = client->id;
+    float before_x = vehicles->x[me], before_y = vehicles->y[me];
+    float prev_x[NET_MAX_PLAYERS], prev_y[NET_MAX_PLAYERS], prev_rotation[NET_MAX_PLAYERS];
+    memcpy(prev_x, vehicles->prev_x, sizeof prev_x);
+    memcpy(prev_y, vehicles->prev_y, sizeof prev_y);
+    memcpy(prev_rotation, vehicles->prev_rotation, sizeof prev_rotation);
+    float camera[4] = {sim->camera_x, sim->camera_y, sim->prev_camera_x, sim->prev_camera_y};
+    unsigned long tick = sim->tick;
+
+    if (input_seq > client->acked_seq) {
+        long long sent = client->input_sent_ns[input_seq % NET_INPUT_HISTORY];
+        if (sent && input_seq <= client->sent_seq) {
+            float rtt = (net_now_ns() - sent) / 1e6f;
+            client->stats.rtt_ms = client->stats.rtt_ms == 0 ? rtt : client->stats.rtt_ms * 0.9f + rtt * 0.1f;
+        }
+        client->acked_seq = input_seq;
+    }
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        net_car_unpack(vehicles, i, snapshot->cars[i]);
+        client->remote_inputs[i] = snapshot->cars[i].flags & 0x0f;
+    }
+    unsigned int first = client->acked_seq + 1;
+    if (client->seq - client->acked_seq >= NET_INPUT_HISTORY) first = client->seq - NET_INPUT_HISTORY + 1;
+    for (unsigned int seq = first; seq <= client->seq; seq++) predict(client, sim, seq);
+
+    memcpy(vehicles->prev_x, prev_x, sizeof prev_x);
+    memcpy(vehicles->prev_y, prev_y, sizeof prev_y);
+    memcpy(vehicles->prev_rotation, prev_rotation, sizeof prev_rotation);
+    sim->camera_x = camera[0];
+    sim->camera_y = camera[1];
+    sim->prev_camera_x = camera[2];
+    sim->prev_camera_y = camera[3];
+    sim->tick = tick;
+
+    float correction = hypotf(vehicles->x[me] - before_x, vehicles->y[me] - before_y);
+    if (client->stats.snapshots > 1) {   // The first one also brings whatever happened before we joined
+        client->stats.correction = correction;
+        if (correction > client->stats.correction_max) client->stats.correction_max = correction;
+        client->stats.correction_sum += correction;
+        if (correction > 0) client->stats.corrections++;
+    }
+}
+
+static void send_inputs(NetClient *client){
+    unsigned int first = client->acked_seq + 1;
+    if (client->seq + 1 - first > NET_MAX_INPUTS_PER_PACKET) first = client->seq + 1 - NET_MAX_INPUTS_PER_PACKET;
+    int count = (int)(client->seq + 1 - first);
+    unsigned char packet[10 + NET_MAX_INPUTS_PER_PACKET], *p = packet;
+    *p++ = NET_MSG_INPUT;
+    p = put_u32(p, client->latest_tick);
+    p = put_u32(p, client->seq);
+    *p++ = (unsigned char)count;
+    long long now = net_now_ns();
+    for (unsigned int seq = first; seq <= client->seq; seq++) {
+        *p++ = (unsigned char)client->inputs[seq % NET_INPUT_HISTORY];
+        if (seq > client->sent_seq) client->input_sent_ns[seq % NET_INPUT_HISTORY] = now;
+    }
+    net_send(&client->socket, client->server, packet, (int)(p - packet));
+    client->sent_seq = client->seq;
+    client->sent_ns = now;
+}
+
+int net_client_update(NetClient *client, SimState *sim){
+    unsigned char data[NET_MAX_PACKET];
+    NetAddress from;
+    int size;
+    NetSnapshot newest;
+    unsigned int newest_seq = 0;
+    int fresh = 0;
+    while ((size = net_receive(&client->socket, &from, data, sizeof data)) > 0) {
+        if (!net_same_address(from, client->server) || data[0] != NET_MSG_SNAPSHOT) continue;
+        client->last_heard_ns = net_now_ns();
+        NetSnapshot snapshot;
+        unsigned int input_seq;
+        if (net_read_snapshot(data, size, client->snapshots, &snapshot, &input_seq) != 0 || snapshot.tick <= client->latest_tick) {
+            client->stats.stale_snapshots++;
+            continue;
+        }
+        client->snapshots[history_slot(snapshot.tick)] = snapshot;
+        client->latest_tick = snapshot.tick;
+        client->active = snapshot.active;
+        client->stats.snapshots++;
+        client->stats.snapshot_bytes += size;
+        if (get_u32(data + 5) == 0) client->stats.full_snapshots++;
+        newest = snapshot;
+        newest_seq = input_seq;
+        fresh = 1;
+    }
+    // Several may arrive in one frame after a hiccup; only the newest matters
+    if (fresh) reconcile(client, sim, &newest, newest_seq);
+
+    long long now = net_now_ns();
+    if (client->seq != client->sent_seq || now - client->sent_ns >= INPUT_HEARTBEAT_NS) send_inputs(client);
+    net_flush(&client->socket);
+
+    if (now - client->rate_start_ns >= 1000000000LL) {
+        float seconds = (now - client->rate_start_ns) / 1e9f;
+        client->stats.up_rate = (client->socket.bytes_sent - client->rate_up) / seconds;
+        client->stats.down_rate = (client->socket.bytes_received - client->rate_down) / seconds;
+        client->rate_up = client->socket.bytes_sent;
+        client->rate_down = client->socket.bytes_received;
+        client->rate_start_ns = now;
+    }
+    return now - client->last_heard_ns > NET_TIMEOUT_NS ? -1 : 0;
+}
+
+void net_client_close(NetClient *client){
+    unsigned char bye = NET_MSG_BYE;
+    for (int i = 0; i < 3; i++) net_send(&client->socket, client->server, &bye, 1);   // In case of loss
+    // Held-back packets still have to go out
+    long long deadline = net_now_ns() + (long long)client->socket.conditions.lag_ms * 1000000LL;
+    while (client->socket.outgoing.count > 0 && net_now_ns() < deadline) {
+        sleep_ns(1000000);
+        net_flush(&client->socket);
+    }
+    net_close(&client->socket);
+}
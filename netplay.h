@@ -0,0 +1,178 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "net.h"
+#include "sim.h"
+
+// ----------------------------
+// MULTIPLAYER (server-authoritative, client-side prediction)
+// ----------------------------
+// A server process owns one world with a car per player slot and steps it at the
+// normal tick rate from the inputs its clients send. Clients run the very same
+// sim_step_players() on their own copy, so their car answers the keys at once,
+// and fold in the server's snapshots as they arrive. Neither side has a window
+// or raylib; main.c draws the client's world like the single-player one.
+
+#define NET_DEFAULT_PORT 40000
+#define NET_MAX_PLAYERS SIM_MAX_PLAYERS
+#define NET_SNAPSHOT_INTERVAL 4          // Ticks between snapshots (30 per second)
+#define NET_SNAPSHOT_HISTORY 64          // Snapshots kept as delta baselines (about 2 s)
+#define NET_INPUT_HISTORY 256            // Inputs a client keeps for replay (about 2 s)
+#define NET_MAX_INPUTS_PER_PACKET 64     // Unacknowledged inputs resent with every packet
+#define NET_INPUT_BACKLOG 12             // Server skips ahead when a client is this far behind
+#define NET_INPUT_REPEAT 12              // Ticks a late client's last keys are held before coasting
+#define NET_TIMEOUT_NS 3000000000LL      // Silence after which a slot is freed (or the server given up on)
+#define NET_CAR_WIDTH 120                // Same car as the windowed game (see headless.c)
+#define NET_CAR_HEIGHT 59
+#define NET_VIEW_WIDTH 1300              // Viewport the server's camera pretends to have
+#define NET_VIEW_HEIGHT 1000
+
+/**
+ * QUANTIZED CAR
+ * -------------
+ * What goes over the wire for one car: position in 1/8 px, facing in 1/65536 of
+ * a turn, speed in 1/64 and a flag byte (bits 0-3 the keys that were held, bit 4
+ * reversing). Both sides round every player car through this after each tick,
+ * so a car rebuilt from a snapshot is exactly the car the server has, and a
+ * client that predicted with the same inputs lands on the very same numbers.
+ */
+typedef struct {
+    int x, y;
+    unsigned short rotation;
+    short speed;
+    unsigned char flags;
+} NetCar;
+
+#define NET_FLAG_REVERSE 0x10
+
+typedef struct {
+    unsigned int tick;                   // Server tick it was taken at (0 = empty)
+    unsigned char active;                // Bit per slot with a connected player
+    NetCar cars[NET_MAX_PLAYERS];
+} NetSnapshot;
+
+/**
+ * SNAPSHOT PACKET
+ * ---------------
+ *   u8 type, u32 tick, u32 baseline tick (0 = full snapshot), u32 last input seq
+ *   the receiving client had applied, u8 active slots, u8 mask of cars that follow
+ * then per car a u8 mask of changed fields and each changed field as a zig-zag
+ * LEB128 varint of its difference from the baseline (from zero in a full one).
+ * The baseline is the newest snapshot the client acknowledged, so a parked car
+ * costs nothing and a moving one a handful of bytes.
+ */
+int net_write_snapshot(unsigned char *out, const NetSnapshot *snapshot, const NetSnapshot *baseline, unsigned int input_seq);
+
+// Reads a packet written by net_write_snapshot(); `baselines` is the receiver's
+// ring of NET_SNAPSHOT_HISTORY snapshots, tick t kept at (t / NET_SNAPSHOT_INTERVAL)
+// % NET_SNAPSHOT_HISTORY. Returns -1 if it is malformed or its baseline is gone.
+int net_read_snapshot(const unsigned char *data, int size, const NetSnapshot *baselines,
+                      NetSnapshot *snapshot, unsigned int *input_seq);
+
+NetCar net_car_pack(const VehicleStore *vehicles, int index, unsigned int input);
+void net_car_unpack(VehicleStore *vehicles, int index, NetCar car);
+
+// ----------------------------
+// SERVER
+// ----------------------------
+typedef struct {
+    int connected;
+    NetAddress address;
+    long long last_heard_ns;
+    unsigned int inputs[NET_INPUT_HISTORY];   // By sequence number
+    unsigned int received_seq;   // Newest input that arrived
+    unsigned int applied_seq;    // Newest input the simulation used
+    unsigned int input;          // Keys used for the last tick
+    int starved;                 // Ticks in a row without a fresh input
+    unsigned int acked_tick;     // Newest snapshot the client confirmed
+    unsigned long bytes_out, bytes_in;        // Totals, for the per-second report
+    unsigned long snapshots, full_snapshots;
+    unsigned long skipped_inputs;             // Thrown away to catch up
+} NetPeer;
+
+typedef struct {
+    NetSocket socket;
+    SimState sim;
+    NetPeer peers[NET_MAX_PLAYERS];
+    NetSnapshot history[NET_SNAPSHOT_HISTORY];   // Everything sent, as baselines for the next ones
+    unsigned int tick;
+    int verbose;                 // Print joins, leaves and a line per client every second
+} NetServer;
+
+typedef struct {
+    int port;
+    int seconds;                 // Stop after this long (0 = run until killed)
+    int world_size;
+    NetConditions conditions;
+    int verbose;
+} NetServerOptions;
+
+// Defaults: NET_DEFAULT_PORT, no time limit, SIM_WORLD_WIDTH, clean link, verbose
+void net_server_default_options(NetServerOptions *options);
+
+// Reads --port N, --server-seconds N, --world-size N, --net-lag MS and --net-loss PCT
+void net_server_parse_args(NetServerOptions *options, int argc, char **argv);
+
+int net_server_init(NetServer *server, const NetServerOptions *options);
+void net_server_free(NetServer *server);
+
+// One tick: read packets, step the world, send snapshots when one is due
+void net_server_tick(NetServer *server);
+
+// `main --server`: ticks at SIM_TICK_RATE in real time; returns the exit status
+int net_server_run(const NetServerOptions *options);
+
+// ----------------------------
+// CLIENT
+// ----------------------------
+typedef struct {
+    float up_rate, down_rate;                 // Bytes per second over the last full second
+    unsigned long snapshots, full_snapshots;  // Received and used
+    unsigned long snapshot_bytes;             // Sum over the snapshots received
+    unsigned long stale_snapshots;            // Arrived after a newer one, or without a baseline
+    float correction;                         // Distance the own car was moved by the last snapshot
+    float correction_max;
+    double correction_sum;
+    unsigned long corrections;                // Snapshots that moved the own car at all
+    float rtt_ms;                             // Input sent to its effect acknowledged, smoothed
+} NetClientStats;
+
+typedef struct {
+    NetSocket socket;
+    NetAddress server;
+    int id;                                   // Our player slot
+    int world_width, world_height;            // From the server's welcome
+    unsigned int seq;                         // Last input issued
+    unsigned int sent_seq;                    // Last input put in a packet
+    long long sent_ns;                        // When the last input packet went out
+    unsigned int inputs[NET_INPUT_HISTORY];
+    long long input_sent_ns[NET_INPUT_HISTORY];
+    unsigned int acked_seq;                   // Last input the server had applied
+    unsigned int remote_inputs[NET_MAX_PLAYERS];   // Keys the others held at the last snapshot
+    NetSnapshot snapshots[NET_SNAPSHOT_HISTORY];
+    unsigned int latest_tick;                 // Newest snapshot received
+    unsigned char active;                     // Slots in use at the latest snapshot
+    long long last_heard_ns;
+    long long rate_start_ns;                  // Start of the second being measured
+    unsigned long rate_up, rate_down;         // Socket totals at that point
+    NetClientStats stats;
+} NetClient;
+
+// Opens a socket and says hello until the server answers (or `timeout_ms` passes).
+// Returns 0 with `id` and the world size filled in, -1 with a message on stderr.
+int net_client_connect(NetClient *client, const char *host, int port, const NetConditions *conditions, int timeout_ms);
+
+// Builds the shared world on this side, camera on our car; 0 or -1 like sim_init()
+int net_client_init_sim(NetClient *client, SimState *sim, int view_width, int view_height);
+
+// Predicts one tick with our keys (everyone else keeps their last known keys)
+void net_client_tick(NetClient *client, SimState *sim, unsigned int input);
+
+// Once per frame: apply snapshots that arrived, then send the unacknowledged inputs.
+// Returns -1 once the server has been silent for NET_TIMEOUT_NS.
+int net_client_update(NetClient *client, SimState *sim);
+
+// Tells the server we are leaving and closes the socket
+void net_client_close(NetClient *client);
+
+#endif
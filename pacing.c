@@ -0,0 +1,121 @@
+#define _POSIX_C_SOURCE 200112L
+#include "pacing.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SPIN_MIN_NS 200000LL     // Always spin at least the last 0.2 ms
+#define SPIN_MAX_NS 4000000LL
+
+const int pacing_targets[PACING_TARGET_COUNT] = {30, 60, 120, 144, 240};
+const char *pacing_mode_names[PACING_MODE_COUNT] = {"Hybrid", "VSync", "Uncapped"};
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int pacing_valid_target(int target_fps){
+    return target_fps < PACING_MIN_FPS ? PACING_MIN_FPS : target_fps > PACING_MAX_FPS ? PACING_MAX_FPS : target_fps;
+}
+
+void pacing_init(Pacer *pacer, PacingMode mode, int target_fps){
+    memset(pacer, 0, sizeof *pacer);
+    pacer->spin_ns = 1000000;
+    pacing_set(pacer, mode, target_fps);
+}
+
+void pacing_set(Pacer *pacer, PacingMode mode, int target_fps){
+    pacer->mode = mode;
+    pacer->target_fps = pacing_valid_target(target_fps);
+    pacer->period_ns = 1000000000LL / pacer->target_fps;
+    pacer->deadline_ns = 0;
+    pacer->head = pacer->count = 0;
+    pacer->latency_head = pacer->latency_count = 0;
+    pacer->last_present_ns = 0;
+    pacer->input_ns = 0;
+}
+
+/**
+ * SLEEP THEN SPIN
+ * ---------------
+ * The OS wakes a sleeping thread up to a millisecond or so late, which shows up
+ * as uneven frame times. So the thread sleeps until `spin_ns` before the deadline
+ * and busy-waits the remainder. `spin_ns` follows the overshoot actually seen:
+ * it doubles past a late wake-up and shrinks slowly while wake-ups are on time,
+ * which keeps the CPU spent spinning small on a quiet machine.
+ *
+ * Deadlines advance by exactly one period, so a frame that ran a little long is
+ * made up on the next one. If a frame is more than a whole period late (stall,
+ * window drag), the schedule restarts from now instead of rushing to catch up.
+ */
+void pacing_wait(Pacer *pacer){
+    if (pacer->mode != PACING_HYBRID) return;
+    long long now = now_ns();
+    if (pacer->deadline_ns == 0 || now - pacer->deadline_ns > pacer->period_ns) pacer->deadline_ns = now;
+
+    long long wake = pacer->deadline_ns - pacer->spin_ns;
+    if (wake > now) {
+        struct timespec until = {wake / 1000000000LL, wake % 1000000000LL};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+        long long overshoot = now_ns() - wake;
+        if (overshoot * 2 > pacer->spin_ns) pacer->spin_ns = overshoot * 2;
+        else pacer->spin_ns -= pacer->spin_ns / 64;
+        if (pacer->spin_ns < SPIN_MIN_NS) pacer->spin_ns = SPIN_MIN_NS;
+        if (pacer->spin_ns > SPIN_MAX_NS) pacer->spin_ns = SPIN_MAX_NS;
+    }
+    while (now_ns() < pacer->deadline_ns) {}
+    pacer->deadline_ns += pacer->period_ns;
+}
+
+void pacing_input_sampled(Pacer *pacer){
+    pacer->input_ns = now_ns();
+}
+
+void pacing_presented(Pacer *pacer){
+    long long now = now_ns();
+    if (pacer->last_present_ns != 0) {
+        long long interval = now - pacer->last_present_ns;
+        pacer->intervals[pacer->head] = interval;
+        pacer->head = (pacer->head + 1) % PACING_HISTORY;
+        if (pacer->count < PACING_HISTORY) pacer->count++;
+    }
+    if (pacer->input_ns != 0) {
+        pacer->latencies[pacer->latency_head] = now - pacer->input_ns;
+        pacer->latency_head = (pacer->latency_head + 1) % PACING_HISTORY;
+        if (pacer->latency_count < PACING_HISTORY) pacer->latency_count++;
+        pacer->input_ns = 0;
+    }
+    pacer->last_present_ns = now;
+}
+
+static int compare_ll(const void *a, const void *b){
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+void pacing_stats(const Pacer *pacer, PacingStats *stats){
+    memset(stats, 0, sizeof *stats);
+    if (pacer->count > 0) {
+        double sum = 0;
+        for (int i = 0; i < pacer->count; i++) sum += pacer->intervals[i];
+        double mean = sum / pacer->count;
+        double variance = 0;
+        for (int i = 0; i < pacer->count; i++) variance += (pacer->intervals[i] - mean) * (pacer->intervals[i] - mean);
+        stats->interval_ms = mean / 1e6;
+        stats->fps = mean > 0 ? 1e9 / mean : 0;
+        stats->jitter_ms = sqrt(variance / pacer->count) / 1e6;
+    }
+    if (pacer->latency_count > 0) {
+        long long sorted[PACING_HISTORY];
+        double sum = 0;
+        for (int i = 0; i < pacer->latency_count; i++) sum += pacer->latencies[i];
+        memcpy(sorted, pacer->latencies, sizeof(long long) * pacer->latency_count);
+        qsort(sorted, pacer->latency_count, sizeof *sorted, compare_ll);
+        stats->latency_ms = sum / pacer->latency_count / 1e6;
+        stats->latency_p99_ms = sorted[pacer->latency_count * 99 / 100] / 1e6;
+    }
+}
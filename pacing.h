@@ -0,0 +1,79 @@
+#ifndef PACING_H
+#define PACING_H
+
+// ----------------------------
+// FRAME PACING
+// ----------------------------
+// Decides when each frame is presented. VSYNC lets the driver block in the buffer
+// swap, HYBRID sleeps until just before the frame's deadline and spins for the
+// rest (sleeping alone wakes up to a millisecond late), UNCAPPED never waits.
+// raylib's own SetTargetFPS wait is switched off (SetTargetFPS(0)) in every mode.
+// Also measures frame intervals and input-to-present latency. No raylib here.
+
+#define PACING_HISTORY 120             // Frames the statistics are computed over
+#define PACING_TARGET_COUNT 5
+#define PACING_MIN_FPS 10              // Any whole target in this range can be configured
+#define PACING_MAX_FPS 1000
+
+typedef enum {
+    PACING_HYBRID,     // Sleep, then spin to the deadline of the chosen target
+    PACING_VSYNC,      // Present on the display's refresh
+    PACING_UNCAPPED,   // As fast as possible
+    PACING_MODE_COUNT
+} PacingMode;
+
+// Presets offered in the settings screen (HYBRID only); others come from the config
+// file or --target-fps
+extern const int pacing_targets[PACING_TARGET_COUNT];
+extern const char *pacing_mode_names[PACING_MODE_COUNT];
+
+typedef struct {
+    PacingMode mode;
+    int target_fps;
+    long long period_ns;
+    long long deadline_ns;                 // When the next frame should be presented
+    long long spin_ns;                     // Margin left for spinning, adapted to sleep overshoot
+    long long last_present_ns;
+    long long input_ns;                    // When this frame read its input, 0 = not yet
+    long long intervals[PACING_HISTORY];   // Present to present
+    long long latencies[PACING_HISTORY];   // Input read to present
+    int head, count;
+    int latency_head, latency_count;
+} Pacer;
+
+typedef struct {
+    double fps;              // Measured
+    double interval_ms;      // Mean frame interval
+    double jitter_ms;        // Standard deviation of the interval
+    double latency_ms;       // Input-to-present latency, mean
+    double latency_p99_ms;   // ... 99th percentile
+} PacingStats;
+
+void pacing_init(Pacer *pacer, PacingMode mode, int target_fps);
+
+// Switches mode/target and restarts the statistics
+void pacing_set(Pacer *pacer, PacingMode mode, int target_fps);
+
+// HYBRID: waits for this frame's deadline. Call right before presenting.
+void pacing_wait(Pacer *pacer);
+
+/**
+ * INPUT-TO-PRESENT LATENCY
+ * ------------------------
+ * Call pacing_input_sampled() where the frame reads the keys and mouse, and
+ * pacing_presented() right after EndDrawing(). The time between the two is that
+ * input's latency (simulation, drawing, pacing wait and, with VSYNC, the blocking
+ * swap); the time between two presents is the frame interval. raylib polls the OS
+ * for events at the end of EndDrawing(), so they were collected shortly before
+ * the read; how long they waited in the OS before, and what the display adds
+ * after, is not visible from here. A frame that read no input adds no sample.
+ */
+void pacing_input_sampled(Pacer *pacer);
+void pacing_presented(Pacer *pacer);
+
+void pacing_stats(const Pacer *pacer, PacingStats *stats);
+
+// `target_fps` clamped to PACING_MIN_FPS .. PACING_MAX_FPS (for config and command line values)
+int pacing_valid_target(int target_fps);
+
+#endif
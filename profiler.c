@@ -0,0 +1,82 @@
+#define _POSIX_C_SOURCE 199309L
+#include "profiler.h"
+#include <string.h>
+#include <time.h>
+
+Profiler profiler;
+
+const char *prof_phase_names[PROF_PHASE_COUNT] = {
+    "input", "audio", "physics", "collision", "camera", "stream", "draw", "present",
+};
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int profiler_open_csv(const char *path){
+    profiler.csv = fopen(path, "w");
+    if (!profiler.csv) return -1;
+    fprintf(profiler.csv, "frame,frame_ms");
+    for (int p = 0; p < PROF_PHASE_COUNT; p++) fprintf(profiler.csv, ",%s_ms", prof_phase_names[p]);
+    fprintf(profiler.csv, "\n");
+    return 0;
+}
+
+void profiler_close(void){
+    if (profiler.csv) fclose(profiler.csv);
+    profiler.csv = NULL;
+}
+
+void profiler_frame_begin(void){
+    memset(&profiler.current, 0, sizeof profiler.current);
+    profiler.depth = 0;
+    profiler.overflow = 0;
+    profiler.frame_start = now_ns();
+}
+
+void profiler_frame_end(void){
+    long long now = now_ns();
+    profiler.overflow = 0;
+    while (profiler.depth > 0) prof_end((ProfPhase)profiler.stack[profiler.depth - 1]);   // Close anything left open
+    profiler.current.frame_ns = now - profiler.frame_start;
+    profiler.frames[profiler.head] = profiler.current;
+    profiler.head = (profiler.head + 1) % PROF_HISTORY;
+    profiler.frame_count++;
+
+    if (profiler.csv) {
+        fprintf(profiler.csv, "%lld,%.4f", profiler.frame_count, profiler.current.frame_ns / 1e6);
+        for (int p = 0; p < PROF_PHASE_COUNT; p++) fprintf(profiler.csv, ",%.4f", profiler.current.phase_ns[p] / 1e6);
+        fprintf(profiler.csv, "\n");
+    }
+}
+
+void prof_begin(ProfPhase phase){
+    if (profiler.depth == PROF_MAX_DEPTH) {
+        profiler.overflow++;   // The matching prof_end must not close a phase that was pushed
+        return;
+    }
+    long long now = now_ns();
+    if (profiler.depth > 0) profiler.current.phase_ns[profiler.stack[profiler.depth - 1]] += now - profiler.mark;
+    profiler.stack[profiler.depth++] = phase;
+    profiler.mark = now;
+}
+
+void prof_end(ProfPhase phase){
+    (void)phase;   // Phases always close innermost first; the argument documents the call site
+    if (profiler.overflow > 0) {
+        profiler.overflow--;
+        return;
+    }
+    long long now = now_ns();
+    if (profiler.depth == 0) return;
+    profiler.current.phase_ns[profiler.stack[--profiler.depth]] += now - profiler.mark;
+    profiler.mark = now;
+}
+
+const ProfFrame *profiler_frame(int back){
+    int index = (profiler.head - 1 - back) % PROF_HISTORY;
+    if (index < 0) index += PROF_HISTORY;
+    return &profiler.frames[index];
+}
@@ -0,0 +1,77 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+
+// ----------------------------
+// FRAME PROFILER
+// ----------------------------
+// Scoped timers around each phase of the main loop. Timings land in a fixed ring
+// of the last PROF_HISTORY frames (no allocation after startup), can be drawn as
+// an overlay (F3) and streamed to a CSV file (--profile-csv FILE). This part has
+// no raylib dependency so the simulation can be timed headless too.
+
+#define PROF_HISTORY 240              // Frames kept for the graph (4 s at 60 FPS)
+#define PROF_MAX_DEPTH 8              // Deepest nesting of prof_begin calls
+
+typedef enum {
+    PROF_INPUT,       // Reading input and running the menu/state logic
+    PROF_AUDIO,       // Queuing commands for the audio thread
+    PROF_PHYSICS,     // AI controls and the vehicle update kernel
+    PROF_COLLISION,   // Broadphase, narrowphase and response
+    PROF_CAMERA,      // Camera follow and clamping
+    PROF_STREAM,      // Queuing world chunks and uploading finished ones
+    PROF_DRAW,        // Building the frame (ground, cars, UI)
+    PROF_PRESENT,     // EndDrawing: buffer swap, vsync and frame-rate wait
+    PROF_PHASE_COUNT
+} ProfPhase;
+
+typedef struct {
+    long long phase_ns[PROF_PHASE_COUNT];   // Exclusive time per phase
+    long long frame_ns;                     // Whole frame, profiler_frame_begin to profiler_frame_end
+} ProfFrame;
+
+typedef struct {
+    ProfFrame frames[PROF_HISTORY];   // Ring of finished frames
+    int head;                         // Next slot to write
+    long long frame_count;            // Frames finished so far
+    ProfFrame current;                // Frame being measured
+    long long frame_start;
+    int stack[PROF_MAX_DEPTH];        // Open phases, innermost last
+    int depth;
+    int overflow;                     // Phases opened past PROF_MAX_DEPTH: untimed, their ends are skipped
+    long long mark;                   // When the innermost phase last resumed
+    int overlay;                      // Draw the overlay (toggled with F3)
+    FILE *csv;                        // Per-frame rows, or NULL
+} Profiler;
+
+extern Profiler profiler;
+
+// Names used in the overlay and as CSV column headers
+extern const char *prof_phase_names[PROF_PHASE_COUNT];
+
+// Opens FILE for per-frame CSV output; returns 0 on success
+int profiler_open_csv(const char *path);
+
+// Flushes and closes the CSV file
+void profiler_close(void);
+
+// Frame boundaries: call begin at the top of the main loop, end after presenting
+void profiler_frame_begin(void);
+void profiler_frame_end(void);
+
+/**
+ * EXCLUSIVE TIMING
+ * ----------------
+ * Phases nest: opening one pauses the phase around it, closing it resumes the
+ * outer one. A frame's phase times therefore add up to (at most) the frame time,
+ * e.g. INPUT wraps the state switch but excludes the PHYSICS ticks inside it.
+ * Past PROF_MAX_DEPTH a phase is not timed; its time stays with the phase around it.
+ */
+void prof_begin(ProfPhase phase);
+void prof_end(ProfPhase phase);
+
+// Most recent finished frame, `back` frames ago (0 = last one)
+const ProfFrame *profiler_frame(int back);
+
+#endif
@@ -0,0 +1,55 @@
+#include <raylib.h>
+#include "profiler.h"
+#include "profiler_overlay.h"
+
+#define GRAPH_HEIGHT 120                 // Pixels for 33.3 ms
+#define GRAPH_RANGE_NS 33333333.0f
+#define AVERAGE_FRAMES 60
+
+static const Color phase_colors[PROF_PHASE_COUNT] = {
+    {255, 203, 0, 255},     // input
+    {200, 122, 255, 255},   // audio
+    {0, 228, 48, 255},      // physics
+    {230, 41, 55, 255},     // collision
+    {102, 191, 255, 255},   // camera
+    {0, 158, 47, 255},      // stream
+    {255, 161, 0, 255},     // draw
+    {130, 130, 130, 255},   // present
+};
+
+void profiler_draw_overlay(int x, int y){
+    int frames = profiler.frame_count < PROF_HISTORY ? (int)profiler.frame_count : PROF_HISTORY;
+    int width = PROF_HISTORY * 2;
+    DrawRectangle(x, y, width + 170, GRAPH_HEIGHT + 10, Fade(BLACK, 0.7f));
+
+    // One 2px column per frame, newest on the right, phases stacked bottom-up
+    for (int i = 0; i < frames; i++) {
+        const ProfFrame *frame = profiler_frame(i);
+        int column = x + width - 2 * (i + 1);
+        float bottom = y + GRAPH_HEIGHT + 5;
+        for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+            float h = frame->phase_ns[p] / GRAPH_RANGE_NS * GRAPH_HEIGHT;
+            if (h < 0.5f) continue;
+            DrawRectangle(column, (int)(bottom - h), 2, (int)h + 1, phase_colors[p]);
+            bottom -= h;
+        }
+    }
+    DrawLine(x, y + 5 + GRAPH_HEIGHT / 2, x + width, y + 5 + GRAPH_HEIGHT / 2, WHITE);   // 16.7 ms
+    DrawLine(x, y + 5, x + width, y + 5, RED);                                          // 33.3 ms
+
+    // Averages over the last second
+    int count = frames < AVERAGE_FRAMES ? frames : AVERAGE_FRAMES;
+    long long totals[PROF_PHASE_COUNT] = {0};
+    long long frame_total = 0;
+    for (int i = 0; i < count; i++) {
+        const ProfFrame *frame = profiler_frame(i);
+        for (int p = 0; p < PROF_PHASE_COUNT; p++) totals[p] += frame->phase_ns[p];
+        frame_total += frame->frame_ns;
+    }
+    if (count == 0) count = 1;
+    int text_x = x + width + 10;
+    DrawText(TextFormat("frame %.2f ms", frame_total / 1e6 / count), text_x, y + 4, 14, WHITE);
+    for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+        DrawText(TextFormat("%-9s %.2f", prof_phase_names[p], totals[p] / 1e6 / count), text_x, y + 20 + p * 15, 14, phase_colors[p]);
+    }
+}
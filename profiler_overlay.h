@@ -0,0 +1,13 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+// ----------------------------
+// PROFILER OVERLAY (F3)
+// ----------------------------
+// Draws the last PROF_HISTORY frames as stacked bars (one colour per phase) with
+// the 16.7 ms and 33.3 ms lines, plus the per-phase average over the last second.
+
+// Draws the overlay with its top-left corner at (x, y), in screen space
+void profiler_draw_overlay(int x, int y);
+
+#endif
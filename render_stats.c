@@ -0,0 +1,13 @@
+#include "render_stats.h"
+
+RenderStats render_stats;
+
+void render_stats_reset(void){
+    render_stats.draw_calls = 0;
+    render_stats.quads = 0;
+}
+
+void render_stats_count(int quads){
+    render_stats.draw_calls++;
+    render_stats.quads += quads;
+}
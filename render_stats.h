@@ -0,0 +1,24 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// ----------------------------
+// DRAW-CALL COUNTER
+// ----------------------------
+// Counts the draw commands the game submits to raylib each frame (one per
+// DrawTexture/DrawTexturePro/... call) and the quads they cover. raylib batches
+// commands internally, so this is the CPU-side submission cost we control.
+
+typedef struct {
+    int draw_calls;
+    int quads;
+} RenderStats;
+
+extern RenderStats render_stats;
+
+// Clears the counters; call once at the start of every frame
+void render_stats_reset(void);
+
+// Records one draw command that submitted `quads` quads
+void render_stats_count(int quads);
+
+#endif
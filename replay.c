@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 199309L
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define OP_TICKS_MAX 0x0F   // Opcodes 0x00-0x0F are tick runs, the value is the input
+#define OP_ESCAPE 0x10
+#define OP_CLICK 0x11
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ----------------------------
+// RECORDING
+// ----------------------------
+static void flush_run(ReplayRecorder *recorder){
+    if (recorder->run_length == 0) return;
+    unsigned char bytes[16];
+    int n = 0;
+    bytes[n++] = (unsigned char)recorder->run_input;
+    unsigned long length = (unsigned long)recorder->run_length;
+    do {
+        unsigned char byte = length & 0x7F;
+        length >>= 7;
+        bytes[n++] = byte | (length ? 0x80 : 0);
+    } while (length);
+    fwrite(bytes, 1, n, recorder->file);
+    recorder->run_length = 0;
+}
+
+int replay_record_begin(ReplayRecorder *recorder, const char *path, const SimState *sim, const App *app){
+    memset(recorder, 0, sizeof *recorder);
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) {
+        fprintf(stderr, "replay: could not open %s for writing\n", path);
+        return -1;
+    }
+    ReplayHeader *header = &recorder->header;
+    header->magic = REPLAY_MAGIC;
+    header->version = REPLAY_VERSION;
+    header->world_width = sim->world_width;
+    header->world_height = sim->world_height;
+    header->view_width = sim->view_width;
+    header->view_height = sim->view_height;
+    header->car_width = sim->car_width;
+    header->car_height = sim->car_height;
+    header->player_count = sim->player_count;
+    header->traffic_count = sim->vehicles.count - sim->player_count;
+    header->start_state = app->state;
+    header->start_fps = app->target_fps;
+    header->start_pacing = app->pacing_mode;
+    fwrite(header, sizeof *header, 1, recorder->file);   // Placeholder, rewritten at the end
+    return 0;
+}
+
+void replay_record_tick(ReplayRecorder *recorder, unsigned int input){
+    input &= OP_TICKS_MAX;
+    if (recorder->run_length > 0 && input != recorder->run_input) flush_run(recorder);
+    recorder->run_input = input;
+    recorder->run_length++;
+    recorder->header.ticks++;
+}
+
+void replay_record_escape(ReplayRecorder *recorder){
+    flush_run(recorder);
+    fputc(OP_ESCAPE, recorder->file);
+}
+
+void replay_record_click(ReplayRecorder *recorder, float x, float y){
+    flush_run(recorder);
+    float position[2] = {x, y};
+    fputc(OP_CLICK, recorder->file);
+    fwrite(position, sizeof position, 1, recorder->file);
+}
+
+int replay_record_end(ReplayRecorder *recorder, const SimState *sim, const App *app){
+    if (!recorder->file) return -1;
+    flush_run(recorder);
+    recorder->header.end_hash = sim_hash(sim);
+    recorder->header.end_state = app->state;
+    recorder->header.end_fps = app->target_fps;
+    recorder->header.end_pacing = app->pacing_mode;
+    int ok = fseek(recorder->file, 0, SEEK_SET) == 0 &&
+             fwrite(&recorder->header, sizeof recorder->header, 1, recorder->file) == 1;
+    ok = fclose(recorder->file) == 0 && ok;
+    recorder->file = NULL;
+    if (!ok) fprintf(stderr, "replay: could not finish the recording\n");
+    return ok ? 0 : -1;
+}
+
+// ----------------------------
+// PLAYBACK
+// ----------------------------
+/**
+ * FAST-FORWARD
+ * ------------
+ * Ticks are fed straight to sim_step() back to back: no rendering, no frame-rate
+ * wait and no accumulator, since the recording already says how many ticks each
+ * input was held for. ESC and clicks go through the same app_escape()/app_click()
+ * as the game, at the same point between ticks as when they were recorded.
+ */
+int replay_run(const char *path){
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "replay: could not open %s\n", path);
+        return 1;
+    }
+    ReplayHeader header;
+    int ok = fread(&header, sizeof header, 1, file) == 1 &&
+             header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION;
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file) - start;
+    fseek(file, start, SEEK_SET);
+    unsigned char *stream = ok && size >= 0 ? malloc(size + 1) : NULL;
+    ok = stream && (size == 0 || fread(stream, size, 1, file) == 1);
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "replay: %s is not a replay file (or is from another version)\n", path);
+        free(stream);
+        return 1;
+    }
+
+    SimState sim;
+    App app;
+    if (sim_init_players(&sim, header.world_width, header.world_height, header.view_width, header.view_height,
+                         header.car_width, header.car_height, header.player_count, header.traffic_count) != 0) {
+        fprintf(stderr, "replay: could not allocate the simulation\n");
+        free(stream);
+        return 1;
+    }
+    app_init(&app, header.view_width, header.view_height);
+    app.state = (GameState)header.start_state;
+    app_set_target_fps(&app, header.start_fps);
+    app.pacing_mode = header.start_pacing;
+
+    long long ticks = 0;
+    long events = 0;
+    int corrupt = 0;
+    long long t0 = now_ns();
+    for (long i = 0; i < size && !corrupt;) {
+        unsigned char op = stream[i++];
+        if (op <= OP_TICKS_MAX) {
+            unsigned long length = 0;
+            int shift = 0;
+            unsigned char byte;
+            do {
+                if (i >= size || shift > 56) { corrupt = 1; break; }
+                byte = stream[i++];
+                length |= (unsigned long)(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            for (unsigned long t = 0; t < length && !corrupt; t++) sim_step(&sim, op);
+            ticks += length;
+        } else if (op == OP_ESCAPE) {
+            app_escape(&app);
+            events++;
+        } else if (op == OP_CLICK && i + 2 * (long)sizeof(float) <= size) {
+            float position[2];
+            memcpy(position, stream + i, sizeof position);
+            i += sizeof position;
+            app_click(&app, position[0], position[1]);
+            events++;
+        } else {
+            corrupt = 1;
+        }
+    }
+    long long elapsed = now_ns() - t0;
+    unsigned int hash = sim_hash(&sim);
+    sim_free(&sim);
+    free(stream);
+
+    double game_seconds = (double)ticks / SIM_TICK_RATE;
+    double seconds = elapsed / 1e9;
+    printf("replay: %s, %lld ticks (%.1f s of game time), %ld menu events, %ld bytes\n",
+           path, ticks, game_seconds, events, size + (long)sizeof header);
+    printf("  replayed in %.1f ms, %.0fx real time\n", seconds * 1000, seconds > 0 ? game_seconds / seconds : 0);
+    printf("  state hash  %08x (recorded %08x)\n", hash, header.end_hash);
+
+    int status = corrupt || ticks != header.ticks || hash != header.end_hash ||
+                 app.state != (GameState)header.end_state || app.target_fps != header.end_fps ||
+                 app.pacing_mode != header.end_pacing;
+    if (corrupt) fprintf(stderr, "replay: stream is truncated or corrupt\n");
+    else if (status) fprintf(stderr, "replay: end state differs from the recording (ticks %lld/%lld, screen %d/%d, fps %d/%d, pacing %d/%d)\n",
+                             ticks, header.ticks, app.state, header.end_state, app.target_fps, header.end_fps,
+                             app.pacing_mode, header.end_pacing);
+    printf("  %s\n", status ? "FAIL" : "PASS");
+    return status;
+}
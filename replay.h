@@ -0,0 +1,67 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include "sim.h"
+#include "app.h"
+
+// ----------------------------
+// INPUT RECORDING AND REPLAY
+// ----------------------------
+// Records what the game reads from the player (the arrow keys fed to every tick,
+// ESC in GAME and left clicks in MENU/SETTINGS) into a small binary file, and plays
+// it back without a window as fast as the simulation runs. The end state is checked
+// against the hash stored at record time, so a replay doubles as a regression test.
+
+#define REPLAY_MAGIC 0x31505252   // "RRP1"
+#define REPLAY_VERSION 3
+
+/**
+ * FILE LAYOUT
+ * -----------
+ * A ReplayHeader, then a stream of one-byte opcodes:
+ *   0x00-0x0F  a run of ticks with these SIM_INPUT_* bits held, followed by the
+ *              run length as a LEB128 varint (7 bits per byte, high bit = more)
+ *   0x10       ESC pressed
+ *   0x11       left click, followed by the mouse x and y as two floats
+ * Keys are held for many ticks at a time, so an hour of driving is a few KB.
+ * The header is rewritten with the tick count and end state when recording stops.
+ */
+typedef struct {
+    int magic, version;
+    int world_width, world_height;   // Everything sim_init_players() needs to rebuild the world
+    int view_width, view_height;
+    int car_width, car_height;
+    int player_count;                // Player cars, ahead of the traffic in the vehicle store
+    int traffic_count;
+    int start_state, start_fps;      // Screen and frame rate when recording began
+    int start_pacing;
+    long long ticks;                 // Simulation ticks in the stream
+    unsigned int end_hash;           // sim_hash() after the last tick
+    int end_state, end_fps, end_pacing;
+} ReplayHeader;
+
+typedef struct {
+    FILE *file;
+    ReplayHeader header;
+    unsigned int run_input;   // Keys of the run being counted
+    long run_length;          // Ticks in it so far (0 = no open run)
+} ReplayRecorder;
+
+// Starts recording to PATH from the current sim/app state; returns 0 on success
+int replay_record_begin(ReplayRecorder *recorder, const char *path, const SimState *sim, const App *app);
+
+// Call before every sim_step with the input it gets
+void replay_record_tick(ReplayRecorder *recorder, unsigned int input);
+
+// Call before app_escape() / app_click()
+void replay_record_escape(ReplayRecorder *recorder);
+void replay_record_click(ReplayRecorder *recorder, float x, float y);
+
+// Writes the end state into the header and closes the file; returns 0 on success
+int replay_record_end(ReplayRecorder *recorder, const SimState *sim, const App *app);
+
+// Plays PATH back headless, prints the timing and returns 0 if the end state matches
+int replay_run(const char *path);
+
+#endif
@@ -0,0 +1,361 @@
+#include "sim.h"
+#include "profiler.h"
+#include "jobs.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VEHICLE_GRAIN 4096   // Cars per job; the usual few hundred run straight on the caller
+#define PAIR_SEARCH_MIN_BODIES 4096   // Below this the broadphase is searched on the caller (see `raceee_bench jobs`)
+
+int sim_init(SimState *sim, int world_width, int world_height,
+             int view_width, int view_height, int car_width, int car_height, int traffic_count){
+    return sim_init_players(sim, world_width, world_height, view_width, view_height, car_width, car_height, 1, traffic_count);
+}
+
+int sim_init_players(SimState *sim, int world_width, int world_height, int view_width, int view_height,
+                     int car_width, int car_height, int player_count, int traffic_count){
+    if (player_count < 1) player_count = 1;
+    if (player_count > SIM_MAX_PLAYERS) player_count = SIM_MAX_PLAYERS;
+    sim->world_width = world_width;
+    sim->world_height = world_height;
+    sim->view_width = view_width;
+    sim->view_height = view_height;
+
+    sim->car_width = car_width;
+    sim->car_height = car_height;
+    sim->camera_threshold = 100.0f;
+
+    VehicleStore *vehicles = &sim->vehicles;
+    sim->obstacles = NULL;
+    memset(&sim->collision, 0, sizeof sim->collision);
+    memset(&sim->frame, 0, sizeof sim->frame);
+    if (vehicles_init(vehicles, player_count + traffic_count) != 0) return -1;
+    vehicles->max_speed = 100;                 // Maximum car speed
+    vehicles->speedup = 10;                    // Acceleration per second
+    vehicles->slowdown = 10;                   // Deceleration when not moving
+    vehicles->min_x = 0;                       // Keep every car inside the world
+    vehicles->min_y = 0;
+    vehicles->max_x = world_width - car_width;
+    vehicles->max_y = world_height - car_height;
+
+    // Players: start in middle of world, facing up (-90 degrees)
+    for (int i = 0; i < player_count; i++) {
+        int offset = (i + 1) / 2 * SIM_PLAYER_SPACING * (i % 2 ? 1 : -1);
+        vehicles_add(vehicles, world_width/2 - car_width/2 + offset, world_height/2 - car_height/2, -90);
+    }
+    sim->player_count = player_count;
+    sim->focus = SIM_PLAYER;
+
+    // AI traffic: scattered with a fixed seed so every run starts the same way
+    unsigned int rng = 2024;
+    for (int i = 0; i < traffic_count; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        float x = (rng >> 8) % (unsigned int)vehicles->max_x;
+        rng = rng * 1664525u + 1013904223u;
+        float y = (rng >> 8) % (unsigned int)vehicles->max_y;
+        rng = rng * 1664525u + 1013904223u;
+        int index = vehicles_add(vehicles, x, y, (float)((rng >> 8) % 360));
+        vehicles->top_speed[index] = 8 + (rng >> 20) % 12;   // Traffic is slower than the player
+    }
+
+    // Obstacles: random boxes, kept clear of the player's starting spot
+    sim->obstacle_count = 0;
+    sim->obstacles = malloc(sizeof(Obb) * SIM_OBSTACLE_COUNT);
+    if (!sim->obstacles || arena_init(&sim->frame, SIM_FRAME_ARENA_BYTES) != 0 ||
+        collision_init(&sim->collision, world_width, world_height, COLLISION_CELL_SIZE,
+                       vehicles->capacity + SIM_OBSTACLE_COUNT) != 0) {
+        sim_free(sim);
+        return -1;
+    }
+    while (sim->obstacle_count < SIM_OBSTACLE_COUNT) {
+        Obb box;
+        rng = rng * 1664525u + 1013904223u;
+        box.x = (rng >> 8) % (unsigned int)world_width;
+        rng = rng * 1664525u + 1013904223u;
+        box.y = (rng >> 8) % (unsigned int)world_height;
+        rng = rng * 1664525u + 1013904223u;
+        box.half_width = 30 + (rng >> 8) % 50;
+        box.half_height = 30 + (rng >> 16) % 50;
+        box.rotation = (float)((rng >> 4) % 90);
+        float dx = box.x - world_width/2, dy = box.y - world_height/2;
+        if (dx * dx + dy * dy < 600.0f * 600.0f) continue;
+        sim->obstacles[sim->obstacle_count++] = box;
+    }
+    sim->contact_count = 0;
+
+    sim->camera_x = vehicles->x[SIM_PLAYER] + car_width/2;
+    sim->camera_y = vehicles->y[SIM_PLAYER] + car_height/2;
+    sim->prev_camera_x = sim->camera_x;
+    sim->prev_camera_y = sim->camera_y;
+    sim->tick = 0;
+    return 0;
+}
+
+void sim_free(SimState *sim){
+    vehicles_free(&sim->vehicles);
+    collision_free(&sim->collision);
+    free(sim->obstacles);
+    sim->obstacles = NULL;
+    arena_free(&sim->frame);
+}
+
+Obb sim_vehicle_box(const SimState *sim, int index){
+    Obb box = {sim->vehicles.x[index], sim->vehicles.y[index],
+               sim->car_width / 2.0f, sim->car_height / 2.0f, sim->vehicles.rotation[index]};
+    return box;
+}
+
+// ----------------------------
+// COLLISIONS
+// ----------------------------
+/**
+ * BROADPHASE → NARROWPHASE → RESPONSE
+ * -----------------------------------
+ * Every body gets a loose axis-aligned box (a car is bounded by the circle through
+ * its corners, so no trig is needed), the spatial hash turns those into candidate
+ * pairs, and each candidate is tested as two rotated rectangles. Overlapping cars
+ * are pushed apart half each and lose half their speed; a car hitting an obstacle
+ * is pushed out completely and stops, like hitting a wall.
+ */
+static void resolve_collisions(SimState *sim){
+    VehicleStore *vehicles = &sim->vehicles;
+    SpatialHash *hash = &sim->collision;
+    int cars = vehicles->count;
+    float radius = sqrtf((float)(sim->car_width * sim->car_width + sim->car_height * sim->car_height)) / 2;
+
+    for (int i = 0; i < cars; i++) {
+        hash->min_x[i] = vehicles->x[i] - radius;
+        hash->min_y[i] = vehicles->y[i] - radius;
+        hash->max_x[i] = vehicles->x[i] + radius;
+        hash->max_y[i] = vehicles->y[i] + radius;
+    }
+    for (int i = 0; i < sim->obstacle_count; i++) {
+        const Obb *box = &sim->obstacles[i];
+        float r = sqrtf(box->half_width * box->half_width + box->half_height * box->half_height);
+        hash->min_x[cars + i] = box->x - r;
+        hash->min_y[cars + i] = box->y - r;
+        hash->max_x[cars + i] = box->x + r;
+        hash->max_y[cars + i] = box->y + r;
+    }
+
+    sim->contact_count = 0;
+    if (collision_build(hash, cars + sim->obstacle_count) != 0 || collision_find_pairs_parallel(hash, &sim->frame, PAIR_SEARCH_MIN_BODIES) < 0) return;
+
+    for (int p = 0; p < hash->pair_count; p++) {
+        int a = hash->pairs[p].a, b = hash->pairs[p].b;
+        if (a >= cars) continue;   // Obstacle against obstacle: both static
+        int b_is_car = b < cars;
+        Obb box_b = b_is_car ? sim_vehicle_box(sim, b) : sim->obstacles[b - cars];
+        float push_x, push_y;
+        if (!collision_obb_overlap(sim_vehicle_box(sim, a), box_b, &push_x, &push_y)) continue;
+
+        sim->contact_count++;
+        if (b_is_car) {
+            vehicles->x[a] += push_x / 2;
+            vehicles->y[a] += push_y / 2;
+            vehicles->x[b] -= push_x / 2;
+            vehicles->y[b] -= push_y / 2;
+            vehicles->speed[a] *= 0.5f;
+            vehicles->speed[b] *= 0.5f;
+        }
+        else {
+            vehicles->x[a] += push_x;
+            vehicles->y[a] += push_y;
+            vehicles->speed[a] = 0;
+        }
+    }
+
+    // Pushes must not move anyone out of the world
+    for (int i = 0; i < cars; i++) {
+        vehicles->x[i] = fminf(fmaxf(vehicles->x[i], vehicles->min_x), vehicles->max_x);
+        vehicles->y[i] = fminf(fmaxf(vehicles->y[i], vehicles->min_y), vehicles->max_y);
+    }
+}
+
+// Job wrappers: both kernels already work on any [begin, end) of the store
+typedef struct {
+    VehicleStore *vehicles;
+    unsigned long tick;
+    float dt;
+} VehicleJob;
+
+static void steer_job(void *data, int begin, int end){
+    VehicleJob *job = data;
+    vehicles_drive_ai(job->vehicles, begin, end, job->tick);
+}
+
+static void move_job(void *data, int begin, int end){
+    VehicleJob *job = data;
+    vehicles_update(job->vehicles, begin, end, job->dt);
+}
+
+void sim_step(SimState *sim, unsigned int input){
+    unsigned int inputs[SIM_MAX_PLAYERS] = {input};
+    sim_step_players(sim, inputs);
+}
+
+void sim_step_players(SimState *sim, const unsigned int *inputs){
+    const float dt = SIM_DT;
+    VehicleStore *vehicles = &sim->vehicles;
+    arena_reset(&sim->frame);   // Scratch from the last tick is no longer referenced
+
+    sim->prev_camera_x = sim->camera_x;
+    sim->prev_camera_y = sim->camera_y;
+
+    // ----------------------------
+    // CAR MOVEMENT
+    // ----------------------------
+    /**
+     * INPUT → CONTROLS
+     * ----------------
+     * Each player's keys become throttle/steer values for its car (only entity 0
+     * outside a networked game), the AI picks controls for everyone else, then a
+     * single kernel moves every car (see vehicles_update for the speed, rotation
+     * and world-boundary rules). UP wins over DOWN and LEFT over RIGHT, as they
+     * always did. Big fleets are split into jobs: a car only reads and writes its
+     * own slots, so any split gives the same result, and moving waits on steering
+     * through the `steered` counter.
+     *
+     * dt is always SIM_DT, no matter how fast the screen refreshes. The render loop
+     * runs as many ticks as real time requires, so at 30 FPS or 144 FPS the car
+     * covers the same distance per real second and ends in the same place.
+     */
+    for (int i = 0; i < sim->player_count; i++) {
+        unsigned int input = inputs[i];
+        vehicles->throttle[i] = (input & SIM_INPUT_UP) ? 1.0f : (input & SIM_INPUT_DOWN) ? -1.0f : 0.0f;
+        vehicles->steer[i] = (input & SIM_INPUT_LEFT) ? -1.0f : (input & SIM_INPUT_RIGHT) ? 1.0f : 0.0f;
+    }
+    prof_begin(PROF_PHYSICS);
+    VehicleJob job = {vehicles, sim->tick, dt};
+    JobCounter steered = {0}, moved = {0};
+    jobs_run(steer_job, &job, sim->player_count, vehicles->count, VEHICLE_GRAIN, NULL, &steered);
+    jobs_run(move_job, &job, 0, vehicles->count, VEHICLE_GRAIN, &steered, &moved);
+    jobs_wait(&steered);
+    jobs_wait(&moved);
+    prof_end(PROF_PHYSICS);
+    prof_begin(PROF_COLLISION);
+    resolve_collisions(sim);
+    prof_end(PROF_COLLISION);
+
+    // ----------------------------
+    // CAMERA FOLLOWING
+    // ----------------------------
+    /**
+     * CAMERA LERP WITH DEAD-ZONE
+     * --------------------------
+     * The camera target only moves when the car drifts farther than
+     * `camera_threshold` from it. Then it is nudged toward the car by a small
+     * fraction each tick: target += delta * (lerp_speed * dt), which is exponential
+     * smoothing (a simple first-order low-pass filter).
+     *
+     * CAMERA CLAMPING
+     * ---------------
+     * The camera target is the world-space point shown at the centre of the screen,
+     * so it is clamped half a viewport away from every world edge.
+     */
+    prof_begin(PROF_CAMERA);
+    float center_x = vehicles->x[sim->focus] + sim->car_width/2;
+    float center_y = vehicles->y[sim->focus] + sim->car_height/2;
+    float distance_x = center_x - sim->camera_x;
+    float distance_y = center_y - sim->camera_y;
+    float total_distance = sqrtf(distance_x * distance_x + distance_y * distance_y);
+
+    if (total_distance > sim->camera_threshold) {
+        float lerp_speed = 2.0f * dt; // smooth camera movement
+        sim->camera_x += distance_x * lerp_speed;
+        sim->camera_y += distance_y * lerp_speed;
+
+        float camera_margin_x = sim->view_width / 2;
+        float camera_margin_y = sim->view_height / 2;
+        if (sim->camera_x < camera_margin_x) sim->camera_x = camera_margin_x;
+        if (sim->camera_x > sim->world_width - camera_margin_x) sim->camera_x = sim->world_width - camera_margin_x;
+        if (sim->camera_y < camera_margin_y) sim->camera_y = camera_margin_y;
+        if (sim->camera_y > sim->world_height - camera_margin_y) sim->camera_y = sim->world_height - camera_margin_y;
+    }
+    prof_end(PROF_CAMERA);
+
+    sim->tick++;
+}
+
+SimCar sim_vehicle(const SimState *sim, int index, float alpha){
+    const VehicleStore *vehicles = &sim->vehicles;
+    SimCar car;
+    car.x = vehicles->prev_x[index] + (vehicles->x[index] - vehicles->prev_x[index]) * alpha;
+    car.y = vehicles->prev_y[index] + (vehicles->y[index] - vehicles->prev_y[index]) * alpha;
+    car.speed = vehicles->speed[index];
+    car.direction = (int)vehicles->direction[index];
+
+    // Take the short way round when the angle wrapped between the two ticks
+    float from = vehicles->prev_rotation[index];
+    float turn = vehicles->rotation[index] - from;
+    if (turn > 180) turn -= 360;
+    if (turn < -180) turn += 360;
+    car.rotation = from + turn * alpha;
+    return car;
+}
+
+void sim_interpolate_camera(const SimState *sim, float alpha, float *camera_x, float *camera_y){
+    *camera_x = sim->prev_camera_x + (sim->camera_x - sim->prev_camera_x) * alpha;
+    *camera_y = sim->prev_camera_y + (sim->camera_y - sim->prev_camera_y) * alpha;
+}
+
+SimRect sim_visible_rect(const SimState *sim, float camera_x, float camera_y, float zoom){
+    float half_w = sim->view_width / (2.0f * zoom);
+    float half_h = sim->view_height / (2.0f * zoom);
+    float left = fmaxf(camera_x - half_w, 0);
+    float top = fmaxf(camera_y - half_h, 0);
+    float right = fminf(camera_x + half_w, (float)sim->world_width);
+    float bottom = fminf(camera_y + half_h, (float)sim->world_height);
+    SimRect r = {left, top, fmaxf(right - left, 0), fmaxf(bottom - top, 0)};
+    return r;
+}
+
+/**
+ * TILE CULLING
+ * ------------
+ * A tile n covers [n * tile_size, (n + 1) * tile_size). The first visible tile is the
+ * one containing the left edge (floor), the last one is the tile containing the
+ * pixel just before the right edge (ceil - 1). The world is 15000px wide, which is
+ * not a multiple of 512, so the last column is only partly inside the world and
+ * the index is clamped to ceil(world / tile) - 1 rather than world / tile.
+ */
+SimTileRange sim_visible_tiles(const SimState *sim, float camera_x, float camera_y, float zoom, int tile_size){
+    SimRect view = sim_visible_rect(sim, camera_x, camera_y, zoom);
+    int last_x = (sim->world_width + tile_size - 1) / tile_size - 1;
+    int last_y = (sim->world_height + tile_size - 1) / tile_size - 1;
+    SimTileRange r;
+    r.start_x = (int)floorf(view.x / tile_size);
+    r.start_y = (int)floorf(view.y / tile_size);
+    r.end_x = (int)ceilf((view.x + view.width) / tile_size) - 1;
+    r.end_y = (int)ceilf((view.y + view.height) / tile_size) - 1;
+    if (r.end_x > last_x) r.end_x = last_x;
+    if (r.end_y > last_y) r.end_y = last_y;
+    return r;
+}
+
+static unsigned int fnv1a(unsigned int hash, const void *data, size_t size){
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+unsigned int sim_hash(const SimState *sim){
+    // Hash field by field so struct padding never leaks into the result
+    const VehicleStore *vehicles = &sim->vehicles;
+    size_t bytes = sizeof(float) * vehicles->count;
+    unsigned int hash = 2166136261u;
+    hash = fnv1a(hash, vehicles->x, bytes);
+    hash = fnv1a(hash, vehicles->y, bytes);
+    hash = fnv1a(hash, vehicles->speed, bytes);
+    hash = fnv1a(hash, vehicles->direction, bytes);
+    hash = fnv1a(hash, vehicles->rotation, bytes);
+    hash = fnv1a(hash, &sim->camera_x, sizeof sim->camera_x);
+    hash = fnv1a(hash, &sim->camera_y, sizeof sim->camera_y);
+    hash = fnv1a(hash, &sim->tick, sizeof sim->tick);
+    return hash;
+}
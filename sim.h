@@ -0,0 +1,122 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "vehicles.h"
+#include "collision.h"
+#include "arena.h"
+
+// ----------------------------
+// FIXED-STEP SIMULATION CORE
+// ----------------------------
+// Everything that decides where the car and camera are lives here. The module has
+// no raylib dependency so it can be stepped without a window (tools, benchmarks).
+
+#define SIM_TICK_RATE 120                        // Simulation ticks per second
+#define SIM_DT (1.0f / SIM_TICK_RATE)            // Length of one tick in seconds
+#define SIM_MAX_STEPS_PER_FRAME 8                // Cap on catch-up ticks after a long frame
+#define SIM_SPEED_SCALE 60.0f                    // car speed is measured in pixels per 1/60 s
+#define ROTATION_SPEED 52                        // Rotation speed of the car in degrees per second
+#define SIM_WORLD_WIDTH 15000                    // World dimensions (large world for car to move in)
+#define SIM_WORLD_HEIGHT 15000
+
+// Inputs the simulation reads each tick (bitmask)
+typedef enum {
+    SIM_INPUT_UP    = 1 << 0,
+    SIM_INPUT_DOWN  = 1 << 1,
+    SIM_INPUT_LEFT  = 1 << 2,
+    SIM_INPUT_RIGHT = 1 << 3,
+} SimInput;
+
+#define SIM_PLAYER 0                             // Index of the player in the vehicle store
+#define SIM_MAX_PLAYERS 8                        // Input-driven cars (networked games), from index 0 up
+#define SIM_PLAYER_SPACING 140                   // Gap between players on the starting row
+#define SIM_TRAFFIC_COUNT 300                    // AI cars spawned around the world
+#define SIM_OBSTACLE_COUNT 150                   // Static rocks/crates scattered around the world
+#define SIM_FRAME_ARENA_BYTES (256 * 1024)       // Per-tick scratch (grows if a tick needs more)
+
+// Kinematic state of one car, as read out of the vehicle store
+typedef struct {
+    float x, y;         // Position (centre of the sprite when drawn)
+    float speed;        // Current speed
+    int direction;      // Forward (-1) or backward (+1)
+    float rotation;     // Facing in degrees, kept in [0, 360)
+} SimCar;
+
+typedef struct {
+    // World and viewport size (the camera never shows outside the world)
+    int world_width, world_height;
+    int view_width, view_height;
+
+    // Car size (shared by every vehicle) and camera tuning
+    int car_width, car_height;
+    float camera_threshold;  // How far car can move before camera follows
+
+    // Every car, players first; keeps the previous tick for render interpolation
+    VehicleStore vehicles;
+    int player_count;        // Vehicles [0, player_count) are driven by inputs, the rest by the AI
+    int focus;               // Vehicle the camera follows (SIM_PLAYER unless networked)
+
+    // Static obstacles and the grid used to find what touches what
+    Obb *obstacles;
+    int obstacle_count;
+    SpatialHash collision;   // Bodies: vehicles first, then obstacles
+    int contact_count;       // Overlapping pairs resolved during the last tick
+    float camera_x, camera_y;
+    float prev_camera_x, prev_camera_y;
+
+    unsigned long tick;      // Number of ticks simulated so far
+    Arena frame;             // Scratch memory for one tick, reset at the start of sim_step
+} SimState;
+
+// Axis-aligned rectangle in world pixels
+typedef struct {
+    float x, y;
+    float width, height;
+} SimRect;
+
+// Range of ground tiles (inclusive) that may be visible around a camera target
+typedef struct {
+    int start_x, start_y;
+    int end_x, end_y;
+} SimTileRange;
+
+// Places the player in the middle of the world with the camera centred on it and
+// scatters `traffic_count` AI cars and SIM_OBSTACLE_COUNT obstacles.
+// Returns 0 on success, -1 if out of memory.
+int sim_init(SimState *sim, int world_width, int world_height,
+             int view_width, int view_height, int car_width, int car_height, int traffic_count);
+
+// Same world with `player_count` (1 to SIM_MAX_PLAYERS) input-driven cars in a row
+// across the middle, player 0 in the centre and the others alternating right and
+// left of it. Traffic and obstacles are placed exactly as with one player.
+int sim_init_players(SimState *sim, int world_width, int world_height, int view_width, int view_height,
+                     int car_width, int car_height, int player_count, int traffic_count);
+
+// Releases the vehicle store, obstacles and collision grid
+void sim_free(SimState *sim);
+
+// Advances the world by exactly one tick of SIM_DT seconds
+void sim_step(SimState *sim, unsigned int input);
+
+// Same, with one SIM_INPUT_* mask per player (`player_count` entries)
+void sim_step_players(SimState *sim, const unsigned int *inputs);
+
+// Vehicle `index` blended between the previous and current tick (alpha in [0, 1])
+SimCar sim_vehicle(const SimState *sim, int index, float alpha);
+
+// Rotated rectangle of vehicle `index` at the current tick
+Obb sim_vehicle_box(const SimState *sim, int index);
+
+// Camera target blended between the previous and current tick
+void sim_interpolate_camera(const SimState *sim, float alpha, float *camera_x, float *camera_y);
+
+// Part of the world seen by a camera centred on (camera_x, camera_y), clipped to the world
+SimRect sim_visible_rect(const SimState *sim, float camera_x, float camera_y, float zoom);
+
+// Tiles overlapping sim_visible_rect(); empty (end < start) if nothing is visible
+SimTileRange sim_visible_tiles(const SimState *sim, float camera_x, float camera_y, float zoom, int tile_size);
+
+// FNV-1a hash of the simulated state, used to detect behaviour changes
+unsigned int sim_hash(const SimState *sim);
+
+#endif
@@ -0,0 +1,205 @@
+#include <raylib.h>
+#include <rlgl.h>
+#include <string.h>
+#include "ui.h"
+
+#define BUTTON_COLOR GRAY
+#define BUTTON_HOVER_COLOR DARKGRAY
+
+void ui_screen_init(UiScreen *screen, int width, int height, Texture2D background){
+    memset(screen, 0, sizeof *screen);
+    screen->width = width;
+    screen->height = height;
+    screen->background = background;
+}
+
+void ui_screen_free(UiScreen *screen){
+    if (!screen->built) return;
+    UnloadRenderTexture(screen->base);
+    UnloadRenderTexture(screen->layer);
+    screen->built = 0;
+}
+
+// ----------------------------
+// DESCRIPTION
+// ----------------------------
+void ui_add_label(UiScreen *screen, const char *text, int x, int y, int font_size, Color color){
+    if (screen->static_count == UI_MAX_STATICS) return;
+    if (x < 0) x = screen->width / 2 - MeasureText(text, font_size) / 2;
+    screen->statics[screen->static_count++] = (UiStatic){text, {0}, {x, y, 0, 0}, font_size, color};
+}
+
+void ui_add_image(UiScreen *screen, Texture2D texture, Rectangle rect){
+    if (screen->static_count == UI_MAX_STATICS) return;
+    screen->statics[screen->static_count++] = (UiStatic){NULL, texture, rect, 0, WHITE};
+}
+
+static UiWidget *add_widget(UiScreen *screen, UiWidgetKind kind, Rectangle bounds, int font_size){
+    if (screen->widget_count == UI_MAX_WIDGETS) return NULL;
+    UiWidget *widget = &screen->widgets[screen->widget_count];
+    memset(widget, 0, sizeof *widget);
+    widget->kind = kind;
+    widget->bounds = bounds;
+    widget->font_size = font_size;
+    widget->drawn_state = -1;
+    return widget;
+}
+
+int ui_add_button(UiScreen *screen, Rectangle rect, const char *caption, int font_size){
+    UiWidget *widget = add_widget(screen, UI_BUTTON, rect, font_size);
+    if (!widget) return -1;
+    widget->options[0] = caption;
+    widget->option_widths[0] = MeasureText(caption, font_size);
+    widget->option_count = 1;
+    return screen->widget_count++;
+}
+
+// The arrows never change, so they go into the static layer; the widget is the gap between them
+int ui_add_selector(UiScreen *screen, Rectangle left_arrow, Rectangle right_arrow, Texture2D left_texture,
+                    Texture2D right_texture, const char *const *options, int option_count, int font_size){
+    float height = left_arrow.height > font_size ? left_arrow.height : font_size;
+    Rectangle gap = {left_arrow.x + left_arrow.width, left_arrow.y, right_arrow.x - left_arrow.x - left_arrow.width, height};
+    UiWidget *widget = add_widget(screen, UI_SELECTOR, gap, font_size);
+    if (!widget) return -1;
+    ui_add_image(screen, left_texture, left_arrow);
+    ui_add_image(screen, right_texture, right_arrow);
+    if (option_count > UI_MAX_OPTIONS) option_count = UI_MAX_OPTIONS;
+    for (int i = 0; i < option_count; i++) {
+        widget->options[i] = options[i];
+        widget->option_widths[i] = MeasureText(options[i], font_size);
+    }
+    widget->option_count = option_count;
+    return screen->widget_count++;
+}
+
+// Spans the full width, since the text and its width change
+int ui_add_text(UiScreen *screen, int y, int font_size){
+    UiWidget *widget = add_widget(screen, UI_TEXT, (Rectangle){0, y, screen->width, font_size}, font_size);
+    if (!widget) return -1;
+    return screen->widget_count++;
+}
+
+// ----------------------------
+// STATE
+// ----------------------------
+void ui_set_value(UiScreen *screen, int id, int value, int dimmed){
+    if (id < 0 || id >= screen->widget_count) return;
+    UiWidget *widget = &screen->widgets[id];
+    if (value < 0 || value >= widget->option_count) value = 0;
+    widget->value = value;
+    widget->dimmed = dimmed != 0;
+}
+
+void ui_set_text(UiScreen *screen, int id, const char *text){
+    if (id < 0 || id >= screen->widget_count) return;
+    UiWidget *widget = &screen->widgets[id];
+    if (strncmp(widget->text, text, UI_TEXT_MAX - 1) == 0) return;
+    strncpy(widget->text, text, UI_TEXT_MAX - 1);
+    widget->text[UI_TEXT_MAX - 1] = '\0';
+    widget->text_width = MeasureText(widget->text, widget->font_size);
+    widget->drawn_state = -1;
+}
+
+// ----------------------------
+// DRAWING
+// ----------------------------
+/**
+ * RENDER TEXTURES
+ * ---------------
+ * OpenGL stores render textures bottom-up, so every source rectangle taken from
+ * one is flipped: negative height, y counted from the bottom. Copies are made with
+ * blending off (ONE, ZERO): anti-aliased text drawn into a texture leaves alpha
+ * below 1 at its edges, and blending that again would let whatever is underneath
+ * show through around the letters.
+ */
+static Rectangle flipped(const RenderTexture2D *target, Rectangle rect){
+    return (Rectangle){rect.x, target->texture.height - rect.y - rect.height, rect.width, -rect.height};
+}
+
+static void begin_copy(void){
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+}
+
+static void draw_base(UiScreen *screen){
+    Texture2D background = screen->background;
+    ClearBackground(BLACK);
+    DrawTexturePro(background, (Rectangle){0, 0, background.width, background.height},
+                   (Rectangle){0, 0, screen->width, screen->height}, (Vector2){0, 0}, 0, WHITE);
+    for (int i = 0; i < screen->static_count; i++) {
+        const UiStatic *item = &screen->statics[i];
+        if (item->text) {
+            DrawText(item->text, (int)item->rect.x, (int)item->rect.y, item->font_size, item->color);
+        } else {
+            DrawTexturePro(item->texture, (Rectangle){0, 0, item->texture.width, item->texture.height},
+                           item->rect, (Vector2){0, 0}, 0, item->color);
+        }
+    }
+}
+
+static void draw_widget(const UiWidget *widget, int hover){
+    Rectangle b = widget->bounds;
+    switch (widget->kind) {
+        case UI_BUTTON:
+            DrawRectangleRec(b, hover ? BUTTON_HOVER_COLOR : BUTTON_COLOR);
+            DrawRectangleLines(b.x, b.y, b.width, b.height, BLACK);
+            DrawText(widget->options[0], (int)(b.x + b.width / 2) - widget->option_widths[0] / 2,
+                     (int)(b.y + b.height / 2) - widget->font_size / 2, widget->font_size, WHITE);
+            break;
+        case UI_SELECTOR:
+            DrawText(widget->options[widget->value], (int)(b.x + b.width / 2) - widget->option_widths[widget->value] / 2,
+                     (int)b.y, widget->font_size, widget->dimmed ? GRAY : BLACK);
+            break;
+        case UI_TEXT:
+            DrawText(widget->text, (int)(b.x + b.width / 2) - widget->text_width / 2, (int)b.y, widget->font_size, BLACK);
+            break;
+    }
+}
+
+/**
+ * DIRTY WIDGETS
+ * -------------
+ * A widget's state is its value, its dimmed flag and whether the mouse is over it
+ * (buttons only), packed into one int. When that differs from what was last drawn
+ * into the layer, its rectangle is restored from the static layer and the widget
+ * drawn again on top. Nothing else in the layer is touched, so an idle menu draws
+ * no text and measures none.
+ */
+void ui_screen_draw(UiScreen *screen, Vector2 mouse){
+    Rectangle full = {0, 0, screen->width, screen->height};
+    if (!screen->built) {
+        screen->base = LoadRenderTexture(screen->width, screen->height);
+        screen->layer = LoadRenderTexture(screen->width, screen->height);
+        screen->built = 1;
+        BeginTextureMode(screen->base);
+        draw_base(screen);
+        EndTextureMode();
+        BeginTextureMode(screen->layer);
+        begin_copy();
+        DrawTextureRec(screen->base.texture, flipped(&screen->base, full), (Vector2){0, 0}, WHITE);
+        EndBlendMode();
+        EndTextureMode();
+    }
+
+    int dirty = 0;
+    for (int i = 0; i < screen->widget_count; i++) {
+        UiWidget *widget = &screen->widgets[i];
+        int hover = widget->kind == UI_BUTTON && CheckCollisionPointRec(mouse, widget->bounds);
+        int state = widget->value | widget->dimmed << 8 | hover << 9;
+        if (state == widget->drawn_state) continue;
+        if (!dirty) BeginTextureMode(screen->layer);
+        dirty = 1;
+        begin_copy();
+        DrawTextureRec(screen->base.texture, flipped(&screen->base, widget->bounds),
+                       (Vector2){widget->bounds.x, widget->bounds.y}, WHITE);
+        EndBlendMode();
+        draw_widget(widget, hover);
+        widget->drawn_state = state;
+        screen->redraws++;
+    }
+    if (dirty) EndTextureMode();
+
+    begin_copy();
+    DrawTextureRec(screen->layer.texture, flipped(&screen->layer, full), (Vector2){0, 0}, WHITE);
+    EndBlendMode();
+}
@@ -0,0 +1,84 @@
+#ifndef UI_H
+#define UI_H
+
+#include <raylib.h>
+
+// ----------------------------
+// RETAINED MENU UI
+// ----------------------------
+// A screen (menu, settings) is described once: static images and labels, plus
+// widgets whose look depends on state (hover, selected value, a line of text).
+// The static parts are drawn once into a render texture. A second render texture
+// holds the finished screen, and only the widgets whose state changed since the
+// last frame are redrawn into it. Each frame then costs one textured quad.
+
+#define UI_MAX_STATICS 16
+#define UI_MAX_WIDGETS 16
+#define UI_MAX_OPTIONS 12   // Enough for the sound row, 0% ... 100%
+#define UI_TEXT_MAX 128
+
+typedef enum {
+    UI_BUTTON,     // Filled rectangle with a centered caption, darker while hovered
+    UI_SELECTOR,   // Value centered between two arrows (the arrows are static)
+    UI_TEXT        // Centered line of text set with ui_set_text
+} UiWidgetKind;
+
+typedef struct {
+    const char *text;      // NULL for an image
+    Texture2D texture;
+    Rectangle rect;        // Image destination, or text position
+    int font_size;
+    Color color;
+} UiStatic;
+
+typedef struct {
+    UiWidgetKind kind;
+    Rectangle bounds;                       // Restored from the static layer before a redraw; UI_BUTTON hover area
+    int font_size;
+    const char *options[UI_MAX_OPTIONS];    // UI_SELECTOR values, UI_BUTTON caption in [0]
+    int option_widths[UI_MAX_OPTIONS];      // MeasureText, once per option
+    int option_count;
+    char text[UI_TEXT_MAX];                 // UI_TEXT
+    int text_width;
+    int value, dimmed;                      // Set by the caller
+    int drawn_state;                        // value, dimmed and hover as currently in the layer; -1 = stale
+} UiWidget;
+
+typedef struct {
+    int width, height;
+    Texture2D background;                   // Stretched over the whole screen
+    UiStatic statics[UI_MAX_STATICS];
+    int static_count;
+    UiWidget widgets[UI_MAX_WIDGETS];
+    int widget_count;
+    RenderTexture2D base;                   // Background and statics
+    RenderTexture2D layer;                  // base + widgets as last drawn
+    int built;
+    unsigned long redraws;                  // Widget redraws since init (for the curious)
+} UiScreen;
+
+void ui_screen_init(UiScreen *screen, int width, int height, Texture2D background);
+
+// Release the render textures (safe if the screen was never drawn)
+void ui_screen_free(UiScreen *screen);
+
+// Static parts, drawn once; x < 0 centers the text horizontally
+void ui_add_label(UiScreen *screen, const char *text, int x, int y, int font_size, Color color);
+void ui_add_image(UiScreen *screen, Texture2D texture, Rectangle rect);
+
+// Widgets; each returns its id. Strings must outlive the screen.
+int ui_add_button(UiScreen *screen, Rectangle rect, const char *caption, int font_size);
+int ui_add_selector(UiScreen *screen, Rectangle left_arrow, Rectangle right_arrow, Texture2D left_texture,
+                    Texture2D right_texture, const char *const *options, int option_count, int font_size);
+int ui_add_text(UiScreen *screen, int y, int font_size);
+
+// Selector value (index into its options) and whether it is greyed out
+void ui_set_value(UiScreen *screen, int id, int value, int dimmed);
+
+// Redraws the text only if it differs from the current one
+void ui_set_text(UiScreen *screen, int id, const char *text);
+
+// Bring changed widgets up to date and draw the screen; call between BeginDrawing/EndDrawing
+void ui_screen_draw(UiScreen *screen, Vector2 mouse);
+
+#endif
@@ -0,0 +1,198 @@
+#include "vehicles.h"
+#include "sim.h"
+#include <stdlib.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846f
+#endif
+
+#define VEHICLE_FIELDS 11   // Number of float arrays in the store (one allocation)
+
+int vehicles_init(VehicleStore *store, int capacity){
+    // One block for all arrays keeps them close together and makes cleanup trivial
+    float *block = malloc(sizeof(float) * VEHICLE_FIELDS * (size_t)capacity);
+    if (!block) return -1;
+
+    store->count = 0;
+    store->capacity = capacity;
+    store->x = block + 0 * (size_t)capacity;
+    store->y = block + 1 * (size_t)capacity;
+    store->speed = block + 2 * (size_t)capacity;
+    store->direction = block + 3 * (size_t)capacity;
+    store->rotation = block + 4 * (size_t)capacity;
+    store->prev_x = block + 5 * (size_t)capacity;
+    store->prev_y = block + 6 * (size_t)capacity;
+    store->prev_rotation = block + 7 * (size_t)capacity;
+    store->throttle = block + 8 * (size_t)capacity;
+    store->steer = block + 9 * (size_t)capacity;
+    store->top_speed = block + 10 * (size_t)capacity;
+
+    store->max_speed = 100;
+    store->speedup = 10;
+    store->slowdown = 10;
+    store->min_x = store->min_y = 0;
+    store->max_x = store->max_y = 0;
+    return 0;
+}
+
+void vehicles_free(VehicleStore *store){
+    free(store->x);
+    store->x = NULL;
+    store->count = store->capacity = 0;
+}
+
+int vehicles_add(VehicleStore *store, float x, float y, float rotation){
+    if (store->count == store->capacity) return -1;
+    int i = store->count++;
+    store->x[i] = store->prev_x[i] = x;
+    store->y[i] = store->prev_y[i] = y;
+    store->rotation[i] = store->prev_rotation[i] = rotation;
+    store->speed[i] = 0;
+    store->top_speed[i] = store->max_speed;
+    store->direction[i] = -1;
+    store->throttle[i] = 0;
+    store->steer[i] = 0;
+    return i;
+}
+
+/**
+ * BRANCH-FREE SINE
+ * ----------------
+ * libm's sinf/cosf are function calls the vectorizer can't see through, so the
+ * kernel uses its own. The angle (radians, in [-PI, PI]) is folded into
+ * [-PI/2, PI/2], where an odd Taylor polynomial up to x^11 is accurate to ~1e-7,
+ * about float precision. Every step is a select, so it vectorizes.
+ */
+static inline float fast_sin(float r){
+    r = r > PI / 2 ? PI - r : r;
+    r = r < -PI / 2 ? -PI - r : r;
+    float r2 = r * r;
+    float p = -2.5052108e-8f;          // -1/11!
+    p = p * r2 + 2.7557319e-6f;        //  1/9!
+    p = p * r2 - 1.9841270e-4f;        // -1/7!
+    p = p * r2 + 8.3333333e-3f;        //  1/5!
+    p = p * r2 - 1.6666667e-1f;        // -1/3!
+    return r + r * r2 * p;
+}
+
+/**
+ * UPDATE KERNEL
+ * -------------
+ * Same rules as the original single-car code, written with selects instead of
+ * if/else so that every vehicle runs the exact same instruction stream:
+ *
+ *   - throttle picks the direction (+1 → forward -1, -1 → backward +1)
+ *     and adds ±accel to speed; with no throttle the car coasts toward 0
+ *     and is clamped so it never crosses zero
+ *   - speed is clamped to ±top_speed
+ *   - steer turns the car, the angle is folded back into [0, 360)
+ *   - the position moves along (cos, sin) of the angle and is clamped to bounds
+ *
+ * The arrays are passed as restrict parameters (GCC ignores restrict on local
+ * copies); without that it would need 50+ runtime overlap checks and gives up.
+ */
+static void update_kernel(const VehicleStore *store, int n, float dt,
+                          float *restrict x, float *restrict y,
+                          float *restrict speed, float *restrict direction, float *restrict rotation,
+                          float *restrict prev_x, float *restrict prev_y, float *restrict prev_rotation,
+                          const float *restrict throttle, const float *restrict steer,
+                          const float *restrict top_speed){
+    const float accel = store->speedup * dt;
+    const float drag = store->slowdown * dt;
+    const float turn = ROTATION_SPEED * dt;
+    const float step = SIM_SPEED_SCALE * dt;
+    const float min_x = store->min_x, max_x = store->max_x;
+    const float min_y = store->min_y, max_y = store->max_y;
+
+    for (int i = 0; i < n; i++) {
+        float t = throttle[i];
+        float dir = direction[i];
+        dir = t > 0 ? -1.0f : dir;
+        dir = t < 0 ? 1.0f : dir;
+
+        float driven = speed[i] + t * accel;
+        float coast = speed[i] + drag * dir;
+        float coast_forward = coast < 0 ? 0 : coast;
+        float coast_backward = coast > 0 ? 0 : coast;
+        coast = dir < 0 ? coast_forward : coast_backward;
+        float s = t == 0 ? coast : driven;
+        s = s > top_speed[i] ? top_speed[i] : s;
+        s = s < -top_speed[i] ? -top_speed[i] : s;
+
+        float rot = rotation[i] + steer[i] * turn;
+        rot = rot >= 360 ? rot - 360 : rot;
+        rot = rot < 0 ? rot + 360 : rot;
+
+        float r = (rot > 180 ? rot - 360 : rot) * (PI / 180.0f);
+        float sin_r = fast_sin(r);
+        float r_cos = r + PI / 2;                      // cos(r) = sin(r + PI/2)
+        r_cos = r_cos > PI ? r_cos - 2 * PI : r_cos;
+        float cos_r = fast_sin(r_cos);
+
+        float nx = x[i] + s * cos_r * step;
+        float ny = y[i] + s * sin_r * step;
+        nx = nx < min_x ? min_x : nx;
+        nx = nx > max_x ? max_x : nx;
+        ny = ny < min_y ? min_y : ny;
+        ny = ny > max_y ? max_y : ny;
+
+        prev_x[i] = x[i];
+        prev_y[i] = y[i];
+        prev_rotation[i] = rotation[i];
+        x[i] = nx;
+        y[i] = ny;
+        speed[i] = s;
+        direction[i] = dir;
+        rotation[i] = rot;
+    }
+}
+
+void vehicles_update(VehicleStore *store, int begin, int end, float dt){
+    if (end <= begin) return;
+    update_kernel(store, end - begin, dt,
+                  store->x + begin, store->y + begin,
+                  store->speed + begin, store->direction + begin, store->rotation + begin,
+                  store->prev_x + begin, store->prev_y + begin, store->prev_rotation + begin,
+                  store->throttle + begin, store->steer + begin, store->top_speed + begin);
+}
+
+/**
+ * WANDERING TRAFFIC
+ * -----------------
+ * Each AI car holds a steering choice for about a second, picked from a hash of
+ * its index and the current second, so traffic is deterministic without storing
+ * any AI state. Cars near the world edge always turn right until they face away
+ * from it (within about 45 degrees of straight back in), then wander again.
+ */
+static void drive_ai_kernel(const VehicleStore *store, int begin, int n, unsigned int second,
+                            const float *restrict x, const float *restrict y, const float *restrict rotation,
+                            float *restrict throttle, float *restrict steer){
+    const float margin = 400;
+    const float left = store->min_x + margin, right = store->max_x - margin;
+    const float top = store->min_y + margin, bottom = store->max_y - margin;
+    for (int i = 0; i < n; i++) {
+        unsigned int h = (unsigned int)(begin + i) * 2654435761u ^ second * 40503u;
+        h ^= h >> 15;
+        h *= 2246822519u;
+        h ^= h >> 13;
+        float wander = (float)(int)(h % 3) - 1;
+        // Pointing back into the world, summed over the edges the car is near (a corner counts both)
+        float inward_x = (float)((x[i] < left) - (x[i] > right));
+        float inward_y = (float)((y[i] < top) - (y[i] > bottom));
+        float r = (rotation[i] > 180 ? rotation[i] - 360 : rotation[i]) * (PI / 180.0f);
+        float r_cos = r + PI / 2;
+        r_cos = r_cos > PI ? r_cos - 2 * PI : r_cos;
+        float facing_in = fast_sin(r_cos) * inward_x + fast_sin(r) * inward_y;
+        float reach = inward_x * inward_x + inward_y * inward_y;   // 0 away from the edges
+        int turn_away = (facing_in < 0) | (facing_in * facing_in < 0.5f * reach);   // More than 45 degrees off
+        throttle[i] = (h >> 8) % 8 == 0 ? 0.0f : 1.0f;
+        steer[i] = turn_away ? 1.0f : wander;
+    }
+}
+
+void vehicles_drive_ai(VehicleStore *store, int begin, int end, unsigned long tick){
+    if (end <= begin) return;
+    drive_ai_kernel(store, begin, end - begin, (unsigned int)(tick / SIM_TICK_RATE),
+                    store->x + begin, store->y + begin, store->rotation + begin,
+                    store->throttle + begin, store->steer + begin);
+}
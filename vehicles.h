@@ -0,0 +1,51 @@
+#ifndef VEHICLES_H
+#define VEHICLES_H
+
+// ----------------------------
+// VEHICLE STORE (structure of arrays)
+// ----------------------------
+// Every car in the world, player included, lives in one store with one array per
+// field. The update kernel walks the arrays front to back with no branches, so
+// the compiler can process 4–8 cars per instruction and 100k+ cars fit easily in
+// a frame. Entity 0 is always the player.
+
+typedef struct {
+    int count, capacity;
+
+    // State (written by vehicles_update)
+    float *x, *y;              // Position (centre of the sprite when drawn)
+    float *speed;              // Speed in pixels per 1/60 s
+    float *top_speed;          // Per-vehicle speed cap (both directions)
+    float *direction;          // Forward (-1) or backward (+1), as a float for the kernel
+    float *rotation;           // Facing in degrees, kept in [0, 360)
+    float *prev_x, *prev_y;    // Position at the previous tick (for interpolation)
+    float *prev_rotation;
+
+    // Controls (read by vehicles_update)
+    float *throttle;           // +1 accelerate, -1 brake/reverse, 0 coast
+    float *steer;              // -1 left, +1 right, 0 straight
+
+    // Tuning shared by every vehicle
+    float max_speed;           // top_speed given to newly added vehicles
+    float speedup;             // Acceleration per second
+    float slowdown;            // Deceleration per second when coasting
+    float min_x, min_y;        // Bounds positions are clamped to
+    float max_x, max_y;
+} VehicleStore;
+
+// Allocates room for `capacity` vehicles; returns 0 on success, -1 if out of memory
+int vehicles_init(VehicleStore *store, int capacity);
+
+// Frees the arrays
+void vehicles_free(VehicleStore *store);
+
+// Appends a parked vehicle (top speed = max_speed) and returns its index, or -1 if the store is full
+int vehicles_add(VehicleStore *store, float x, float y, float rotation);
+
+// Advances vehicles [begin, end) by one step of dt seconds
+void vehicles_update(VehicleStore *store, int begin, int end, float dt);
+
+// Simple wandering traffic: sets throttle/steer of vehicles [begin, end) for this tick
+void vehicles_drive_ai(VehicleStore *store, int begin, int end, unsigned long tick);
+
+#endif
@@ -0,0 +1,377 @@
+#include "world.h"
+#include "jobs.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_PIXEL_BYTES (WORLD_CHUNK_TEXELS * WORLD_CHUNK_TEXELS * 4)
+#define PREFETCH_STEPS 4   // Points along the velocity where the view is sampled
+
+size_t world_chunk_bytes(void){
+    return 2 * CHUNK_PIXEL_BYTES + sizeof(Chunk);
+}
+
+// ----------------------------
+// GENERATION (worker thread)
+// ----------------------------
+/**
+ * VALUE NOISE
+ * -----------
+ * Every integer lattice point gets a pseudo-random value from a hash of its
+ * coordinates and the seed; points in between are blended with a smoothstep.
+ * Because it only depends on world position, neighbouring chunks agree along
+ * their shared edge and a chunk evicted and rebuilt later looks the same.
+ */
+static unsigned int hash_coords(int x, int y, unsigned int seed){
+    unsigned int h = seed ^ ((unsigned int)x * 0x8da6b343u) ^ ((unsigned int)y * 0xd8163841u);
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return h;
+}
+
+static float lattice(int x, int y, unsigned int seed){
+    return (hash_coords(x, y, seed) & 0xFFFF) / 65535.0f;
+}
+
+static float value_noise(float x, float y, unsigned int seed){
+    float fx = floorf(x), fy = floorf(y);
+    int ix = (int)fx, iy = (int)fy;
+    float tx = x - fx, ty = y - fy;
+    tx = tx * tx * (3 - 2 * tx);
+    ty = ty * ty * (3 - 2 * ty);
+    float top = lattice(ix, iy, seed) + (lattice(ix + 1, iy, seed) - lattice(ix, iy, seed)) * tx;
+    float bottom = lattice(ix, iy + 1, seed) + (lattice(ix + 1, iy + 1, seed) - lattice(ix, iy + 1, seed)) * tx;
+    return top + (bottom - top) * ty;
+}
+
+// 0..1 across the terrain types, changing over a few thousand pixels
+static float biome(float x, float y, unsigned int seed){
+    return value_noise(x / 6000, y / 6000, seed) * 0.7f + value_noise(x / 1500, y / 1500, seed + 1) * 0.3f;
+}
+
+static TerrainType terrain_at(float b){
+    if (b < 0.3f) return TERRAIN_MUD;
+    if (b < 0.5f) return TERRAIN_SOIL;
+    if (b < 0.7f) return TERRAIN_GRASS;
+    return TERRAIN_SAND;
+}
+
+// Multiplied over the soil texture, so white leaves the soil as it is
+static const float terrain_tints[TERRAIN_COUNT][3] = {
+    [TERRAIN_SOIL] = {255, 255, 255},
+    [TERRAIN_GRASS] = {165, 205, 130},
+    [TERRAIN_SAND] = {255, 238, 185},
+    [TERRAIN_MUD] = {150, 120, 100},
+};
+
+static void generate_chunk(Chunk *chunk, unsigned int seed){
+    float origin_x = (float)chunk->cx * WORLD_CHUNK_SIZE;
+    float origin_y = (float)chunk->cy * WORLD_CHUNK_SIZE;
+    float step = (float)WORLD_CHUNK_SIZE / (WORLD_CHUNK_TEXELS - 1);   // Edge texels sit on the chunk border
+
+    for (int ty = 0; ty < WORLD_CHUNK_TEXELS; ty++) {
+        for (int tx = 0; tx < WORLD_CHUNK_TEXELS; tx++) {
+            float x = origin_x + tx * step;
+            float y = origin_y + ty * step;
+            // Blend between the two nearest terrain tints so borders are soft
+            float b = biome(x, y, seed) * (TERRAIN_COUNT - 1);
+            int low = (int)b;
+            if (low > TERRAIN_COUNT - 2) low = TERRAIN_COUNT - 2;
+            if (low < 0) low = 0;
+            float t = b - low;
+            static const int order[TERRAIN_COUNT] = {TERRAIN_MUD, TERRAIN_SOIL, TERRAIN_GRASS, TERRAIN_SAND};
+            const float *from = terrain_tints[order[low]];
+            const float *to = terrain_tints[order[low + 1]];
+            float shade = 0.9f + value_noise(x / 180, y / 180, seed + 2) * 0.15f;
+            unsigned char *pixel = chunk->pixels + (ty * WORLD_CHUNK_TEXELS + tx) * 4;
+            for (int c = 0; c < 3; c++) {
+                float value = (from[c] + (to[c] - from[c]) * t) * shade;
+                pixel[c] = (unsigned char)(value > 255 ? 255 : value);
+            }
+            pixel[3] = 255;
+        }
+    }
+
+    float center_x = origin_x + WORLD_CHUNK_SIZE / 2, center_y = origin_y + WORLD_CHUNK_SIZE / 2;
+    chunk->terrain = terrain_at(biome(center_x, center_y, seed));
+
+    // Decorations follow the terrain under them
+    unsigned int rng = hash_coords(chunk->cx, chunk->cy, seed + 3);
+    chunk->decoration_count = 4 + (int)(rng % (WORLD_MAX_DECORATIONS - 3));
+    for (int i = 0; i < chunk->decoration_count; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        float x = origin_x + (rng >> 8) % WORLD_CHUNK_SIZE;
+        rng = rng * 1664525u + 1013904223u;
+        float y = origin_y + (rng >> 8) % WORLD_CHUNK_SIZE;
+        rng = rng * 1664525u + 1013904223u;
+        Decoration *decoration = &chunk->decorations[i];
+        decoration->x = x;
+        decoration->y = y;
+        decoration->radius = 10 + (rng >> 8) % 30;
+        switch (terrain_at(biome(x, y, seed))) {
+            case TERRAIN_MUD: decoration->kind = DECORATION_PUDDLE; decoration->radius *= 1.5f; break;
+            case TERRAIN_GRASS: decoration->kind = (rng >> 20) % 4 ? DECORATION_BUSH : DECORATION_ROCK; break;
+            case TERRAIN_SAND: decoration->kind = DECORATION_ROCK; break;
+            default: decoration->kind = (rng >> 20) % 2 ? DECORATION_BUSH : DECORATION_ROCK; break;
+        }
+    }
+}
+
+static int queue_pop(int *queue, int *head, int *count, int capacity){
+    int slot = queue[*head];
+    *head = (*head + 1) % capacity;
+    (*count)--;
+    return slot;
+}
+
+static void queue_push(int *queue, int head, int *count, int capacity, int slot){
+    queue[(head + *count) % capacity] = slot;
+    (*count)++;
+}
+
+typedef struct {
+    World *world;
+    const int *slots;
+} ChunkBatch;
+
+static void generate_job(void *data, int begin, int end){
+    ChunkBatch *batch = data;
+    for (int i = begin; i < end; i++) generate_chunk(&batch->world->slots[batch->slots[i]], batch->world->seed);
+}
+
+/**
+ * BATCHES
+ * -------
+ * The worker takes one chunk per job-system thread off the queues (urgent first)
+ * and builds them in parallel, one chunk per job. Chunks only depend on their own
+ * coordinates, so they can be built in any order. With a single thread this is
+ * the same one-chunk-at-a-time loop as before, and a batch is never bigger than
+ * what the pool finishes in about one chunk's time.
+ */
+static void *world_worker(void *arg){
+    World *world = arg;
+    int batch[JOBS_MAX_THREADS];
+    pthread_mutex_lock(&world->lock);
+    for (;;) {
+        while (!world->quit && world->urgent_count == 0 && world->prefetch_count == 0) {
+            pthread_cond_wait(&world->wake, &world->lock);
+        }
+        if (world->quit) break;
+        int count = 0, max = jobs_thread_count();
+        while (count < max && (world->urgent_count > 0 || world->prefetch_count > 0)) {
+            int slot = world->urgent_count > 0
+                ? queue_pop(world->urgent, &world->urgent_head, &world->urgent_count, world->queue_capacity)
+                : queue_pop(world->prefetch, &world->prefetch_head, &world->prefetch_count, world->queue_capacity);
+            if (!world->slots[slot].pending) continue;   // Already built through the other queue
+            world->slots[slot].pending = 0;
+            batch[count++] = slot;
+        }
+        if (count == 0) continue;
+        pthread_mutex_unlock(&world->lock);
+
+        ChunkBatch job = {world, batch};
+        parallel_for(0, count, 1, generate_job, &job);
+
+        pthread_mutex_lock(&world->lock);
+        for (int i = 0; i < count; i++) {
+            queue_push(world->ready, world->ready_head, &world->ready_count, world->slot_count, batch[i]);
+        }
+    }
+    pthread_mutex_unlock(&world->lock);
+    return NULL;
+}
+
+// ----------------------------
+// CACHE (render thread)
+// ----------------------------
+static void free_buffers(World *world){
+    free(world->slots);
+    free(world->buckets);
+    free(world->urgent);
+    free(world->prefetch);
+    free(world->ready);
+}
+
+int world_init(World *world, unsigned int seed, int cache_mb){
+    memset(world, 0, sizeof *world);
+    world->seed = seed;
+    world->memory_bytes = (size_t)(cache_mb > 0 ? cache_mb : WORLD_DEFAULT_CACHE_MB) << 20;
+    world->slot_count = (int)(world->memory_bytes / world_chunk_bytes());
+    if (world->slot_count < WORLD_MIN_SLOTS) {
+        fprintf(stderr, "world: a %d MB chunk cache is too small, using %d chunks\n", cache_mb, WORLD_MIN_SLOTS);
+        world->slot_count = WORLD_MIN_SLOTS;
+    }
+    int buckets = 1;
+    while (buckets < world->slot_count * 2) buckets <<= 1;
+    world->bucket_mask = buckets - 1;
+    world->queue_capacity = world->slot_count * 2;   // A slot can sit in both queues
+
+    world->slots = calloc(world->slot_count, sizeof *world->slots);
+    world->buckets = malloc(sizeof(int) * buckets);
+    world->urgent = malloc(sizeof(int) * world->queue_capacity);
+    world->prefetch = malloc(sizeof(int) * world->queue_capacity);
+    world->ready = malloc(sizeof(int) * world->slot_count);
+    unsigned char *pixels = malloc((size_t)world->slot_count * CHUNK_PIXEL_BYTES);
+    if (!world->slots || !world->buckets || !world->urgent || !world->prefetch || !world->ready || !pixels) {
+        free(pixels);
+        free_buffers(world);
+        return -1;
+    }
+    for (int i = 0; i < buckets; i++) world->buckets[i] = -1;
+    for (int i = 0; i < world->slot_count; i++) {
+        world->slots[i].pixels = pixels + (size_t)i * CHUNK_PIXEL_BYTES;
+        world->slots[i].next = -1;
+    }
+
+    pthread_mutex_init(&world->lock, NULL);
+    pthread_cond_init(&world->wake, NULL);
+    if (pthread_create(&world->worker, NULL, world_worker, world) != 0) {
+        pthread_mutex_destroy(&world->lock);
+        pthread_cond_destroy(&world->wake);
+        free(pixels);
+        free_buffers(world);
+        return -1;
+    }
+    return 0;
+}
+
+void world_free(World *world){
+    pthread_mutex_lock(&world->lock);
+    world->quit = 1;
+    pthread_cond_signal(&world->wake);
+    pthread_mutex_unlock(&world->lock);
+    pthread_join(world->worker, NULL);
+    pthread_mutex_destroy(&world->lock);
+    pthread_cond_destroy(&world->wake);
+    free(world->slots[0].pixels);   // One block for every slot
+    free_buffers(world);
+}
+
+static int bucket_of(const World *world, int cx, int cy){
+    return (int)(hash_coords(cx, cy, 0) & (unsigned int)world->bucket_mask);
+}
+
+static int find_slot(const World *world, int cx, int cy){
+    for (int i = world->buckets[bucket_of(world, cx, cy)]; i >= 0; i = world->slots[i].next) {
+        if (world->slots[i].cx == cx && world->slots[i].cy == cy) return i;
+    }
+    return -1;
+}
+
+const Chunk *world_chunk(const World *world, int cx, int cy){
+    int slot = find_slot(world, cx, cy);
+    return slot >= 0 ? &world->slots[slot] : NULL;
+}
+
+static void unlink_slot(World *world, int slot){
+    int *link = &world->buckets[bucket_of(world, world->slots[slot].cx, world->slots[slot].cy)];
+    while (*link != slot) link = &world->slots[*link].next;
+    *link = world->slots[slot].next;
+}
+
+/**
+ * LRU EVICTION
+ * ------------
+ * A free slot is used if there is one. Otherwise the READY chunk that was wanted
+ * longest ago is dropped, as long as it wasn't wanted this frame. Chunks still
+ * queued are skipped: the worker may be writing into them.
+ */
+static int claim_slot(World *world){
+    int oldest = -1;
+    for (int i = 0; i < world->slot_count; i++) {
+        Chunk *chunk = &world->slots[i];
+        if (chunk->state == CHUNK_FREE) return i;
+        if (chunk->state == CHUNK_READY && chunk->last_used < world->frame &&
+            (oldest < 0 || chunk->last_used < world->slots[oldest].last_used)) oldest = i;
+    }
+    if (oldest >= 0) {
+        unlink_slot(world, oldest);
+        world->slots[oldest].state = CHUNK_FREE;
+        world->stats.evicted++;
+    }
+    return oldest;
+}
+
+// Marks the chunk as wanted this frame and queues it if it isn't resident.
+// Returns 0 if it could not be queued (no queue space or no evictable slot).
+static int request_chunk(World *world, int cx, int cy, int urgent){
+    int slot = find_slot(world, cx, cy);
+    if (slot >= 0) {
+        Chunk *chunk = &world->slots[slot];
+        chunk->last_used = world->frame;
+        // Came into view while still waiting in the prefetch queue: move it up
+        if (urgent && !chunk->urgent && chunk->state == CHUNK_QUEUED && world->urgent_count < world->queue_capacity) {
+            chunk->urgent = 1;
+            queue_push(world->urgent, world->urgent_head, &world->urgent_count, world->queue_capacity, slot);
+        }
+        return 1;
+    }
+
+    int count = urgent ? world->urgent_count : world->prefetch_count;
+    if (count >= world->queue_capacity || (slot = claim_slot(world)) < 0) {
+        world->stats.dropped++;
+        return 0;
+    }
+    Chunk *chunk = &world->slots[slot];
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->state = CHUNK_QUEUED;
+    chunk->last_used = world->frame;
+    int bucket = bucket_of(world, cx, cy);
+    chunk->next = world->buckets[bucket];
+    world->buckets[bucket] = slot;
+    chunk->pending = 1;
+    chunk->urgent = urgent;
+    if (urgent) queue_push(world->urgent, world->urgent_head, &world->urgent_count, world->queue_capacity, slot);
+    else queue_push(world->prefetch, world->prefetch_head, &world->prefetch_count, world->queue_capacity, slot);
+    return 1;
+}
+
+static void request_rect(World *world, float x, float y, float width, float height, int border, int urgent){
+    int start_x = (int)floorf(x / WORLD_CHUNK_SIZE) - border;
+    int start_y = (int)floorf(y / WORLD_CHUNK_SIZE) - border;
+    int end_x = (int)floorf((x + width) / WORLD_CHUNK_SIZE) + border;
+    int end_y = (int)floorf((y + height) / WORLD_CHUNK_SIZE) + border;
+    for (int cy = start_y; cy <= end_y; cy++) {
+        for (int cx = start_x; cx <= end_x; cx++) request_chunk(world, cx, cy, urgent);
+    }
+}
+
+void world_update(World *world, SimRect visible, float velocity_x, float velocity_y){
+    world->frame++;
+    // Held for the whole request pass: finding and claiming slots, `pending` and both
+    // queues, so the worker never pops a half-claimed slot. It waits here at most once
+    // per frame, while it takes its next batch or hands one back.
+    pthread_mutex_lock(&world->lock);
+    request_rect(world, visible.x, visible.y, visible.width, visible.height, 0, 1);
+    request_rect(world, visible.x, visible.y, visible.width, visible.height, 1, 0);
+    for (int step = 1; step <= PREFETCH_STEPS; step++) {
+        float ahead = WORLD_PREFETCH_SECONDS * step / PREFETCH_STEPS;
+        request_rect(world, visible.x + velocity_x * ahead, visible.y + velocity_y * ahead,
+                     visible.width, visible.height, 0, 0);
+    }
+    if (world->urgent_count > 0 || world->prefetch_count > 0) pthread_cond_signal(&world->wake);
+    pthread_mutex_unlock(&world->lock);
+}
+
+int world_take_ready(World *world, int *slots, int max){
+    int taken = 0;
+    pthread_mutex_lock(&world->lock);
+    while (taken < max && world->ready_count > 0) {
+        int slot = queue_pop(world->ready, &world->ready_head, &world->ready_count, world->slot_count);
+        world->slots[slot].state = CHUNK_READY;
+        slots[taken++] = slot;
+    }
+    pthread_mutex_unlock(&world->lock);
+    world->stats.generated += taken;
+    return taken;
+}
+
+void world_end_frame(World *world, int missing, long long stream_ns){
+    world->stats.frames++;
+    world->stats.missing_chunks += missing;
+    if (missing > 0 || stream_ns > WORLD_STREAM_BUDGET_NS) world->stats.missed_frames++;
+    if (stream_ns > world->stats.worst_stream_ns) world->stats.worst_stream_ns = stream_ns;
+}
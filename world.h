@@ -0,0 +1,139 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <pthread.h>
+#include "sim.h"
+
+// ----------------------------
+// STREAMING CHUNK WORLD
+// ----------------------------
+// The ground is split into WORLD_CHUNK_SIZE squares addressed by integer chunk
+// coordinates, so there is no limit on how far it reaches. This is scenery only:
+// the simulation keeps its fixed world rectangle (SimState's world_width and
+// world_height, --world-size), and cars cannot leave it. Each chunk gets a
+// terrain tint map and decorations generated from its coordinates on a worker
+// thread, ahead of the camera, and lives in a fixed pool of slots sized by a memory
+// cap; the least recently used chunk is evicted when the pool is full. This part
+// has no raylib dependency (see world_draw.h for uploading and drawing).
+
+#define WORLD_CHUNK_SIZE 1024             // World pixels per chunk side
+#define WORLD_CHUNK_TEXELS 32             // Tint map resolution per chunk side
+#define WORLD_MAX_DECORATIONS 12
+#define WORLD_DEFAULT_CACHE_MB 8          // --chunk-cache-mb
+#define WORLD_MIN_SLOTS 64                // Enough for the view plus prefetch at any cap
+#define WORLD_PREFETCH_SECONDS 1.0f       // How far ahead of the car chunks are requested
+#define WORLD_STREAM_BUDGET_NS 1000000LL  // Streaming work allowed on the render thread per frame
+
+typedef enum {
+    TERRAIN_SOIL,
+    TERRAIN_GRASS,
+    TERRAIN_SAND,
+    TERRAIN_MUD,
+    TERRAIN_COUNT
+} TerrainType;
+
+typedef enum {
+    DECORATION_ROCK,
+    DECORATION_BUSH,
+    DECORATION_PUDDLE
+} DecorationKind;
+
+typedef struct {
+    float x, y, radius;   // World pixels
+    int kind;             // DecorationKind
+} Decoration;
+
+/**
+ * SLOT OWNERSHIP
+ * --------------
+ * `state` and the lookup table belong to the render thread. A QUEUED slot's
+ * contents belong to the worker until it hands the slot back through the ready
+ * list, so QUEUED slots are never evicted and READY ones are never written by the
+ * worker. The mutex guards the queues and `pending`; the render thread holds it
+ * through a frame's whole request pass and the worker while it takes or returns a
+ * batch, never while a chunk is being generated.
+ */
+typedef enum {
+    CHUNK_FREE,     // Slot unused
+    CHUNK_QUEUED,   // Requested; the worker is (or will be) filling it in
+    CHUNK_READY     // Generated and handed back; drawable once uploaded
+} ChunkState;
+
+typedef struct {
+    int cx, cy;                        // Chunk coordinates (world pixels / WORLD_CHUNK_SIZE)
+    ChunkState state;
+    TerrainType terrain;               // Terrain at the chunk centre
+    unsigned char *pixels;             // RGBA tint, WORLD_CHUNK_TEXELS squared
+    Decoration decorations[WORLD_MAX_DECORATIONS];
+    int decoration_count;
+    unsigned long last_used;           // Frame the chunk was last wanted
+    int next;                          // Next slot in the same hash bucket, or -1
+    int pending;                       // Still to be generated (guarded by the lock)
+    int urgent;                        // Already pushed on the urgent queue
+} Chunk;
+
+typedef struct {
+    unsigned long frames;
+    unsigned long generated;        // Chunks built by the worker and handed back
+    unsigned long evicted;          // Chunks dropped to make room
+    unsigned long dropped;          // Requests skipped because every slot was in use
+    unsigned long missed_frames;    // Frames that showed a hole or overran the budget
+    unsigned long missing_chunks;   // Visible chunks not ready in time, summed over frames
+    long long worst_stream_ns;      // Longest streaming work in one frame
+} WorldStats;
+
+typedef struct {
+    unsigned int seed;
+    Chunk *slots;
+    int slot_count;
+    size_t memory_bytes;               // What the slots (and their GPU copies) may use
+    int *buckets;                      // Hash of chunk coordinates -> first slot
+    int bucket_mask;
+    unsigned long frame;
+
+    // Shared with the worker, guarded by `lock`
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int *urgent;                       // Visible chunks, generated first
+    int *prefetch;                     // Chunks the car is heading towards
+    int queue_capacity;
+    int urgent_head, urgent_count;
+    int prefetch_head, prefetch_count;
+    int *ready;                        // Finished slots for the render thread (FIFO)
+    int ready_head, ready_count;
+    int quit;
+
+    WorldStats stats;
+} World;
+
+// Allocates every slot up front for the given cap and starts the worker; 0 on success
+int world_init(World *world, unsigned int seed, int cache_mb);
+
+// Stops the worker and frees the pool
+void world_free(World *world);
+
+/**
+ * PREFETCH
+ * --------
+ * Marks the chunks under `visible` as used this frame and queues any that are
+ * missing as urgent. The one-chunk border around it, and the same rectangle swept
+ * WORLD_PREFETCH_SECONDS along the car's velocity (world px/s), are queued at low
+ * priority, so at full speed the road ahead is usually ready before it scrolls
+ * into view. Never waits for the worker.
+ */
+void world_update(World *world, SimRect visible, float velocity_x, float velocity_y);
+
+// Takes up to `max` generated chunks (now CHUNK_READY) and returns their slots for upload
+int world_take_ready(World *world, int *slots, int max);
+
+// Resident chunk at the given coordinates, or NULL
+const Chunk *world_chunk(const World *world, int cx, int cy);
+
+// Records how the frame went for the stats (missing visible chunks, streaming time)
+void world_end_frame(World *world, int missing, long long stream_ns);
+
+// Bytes of tint data per chunk (one CPU copy plus one GPU copy is budgeted)
+size_t world_chunk_bytes(void);
+
+#endif
@@ -0,0 +1,90 @@
+#include "world_draw.h"
+#include "render_stats.h"
+#include <math.h>
+#include <stdlib.h>
+
+static const Color decoration_colors[] = {
+    [DECORATION_ROCK] = {120, 115, 110, 255},
+    [DECORATION_BUSH] = {70, 110, 45, 255},
+    [DECORATION_PUDDLE] = {90, 70, 55, 200},
+};
+
+int world_renderer_init(WorldRenderer *renderer, World *world){
+    renderer->world = world;
+    renderer->textures = calloc(world->slot_count, sizeof *renderer->textures);
+    return renderer->textures ? 0 : -1;
+}
+
+void world_renderer_free(WorldRenderer *renderer){
+    for (int i = 0; i < renderer->world->slot_count; i++) {
+        if (renderer->textures[i].id != 0) UnloadTexture(renderer->textures[i]);
+    }
+    free(renderer->textures);
+}
+
+void world_renderer_upload(WorldRenderer *renderer){
+    int slots[WORLD_UPLOADS_PER_FRAME];
+    int count = world_take_ready(renderer->world, slots, WORLD_UPLOADS_PER_FRAME);
+    for (int i = 0; i < count; i++) {
+        Texture2D *texture = &renderer->textures[slots[i]];
+        unsigned char *pixels = renderer->world->slots[slots[i]].pixels;
+        if (texture->id == 0) {
+            Image image = {pixels, WORLD_CHUNK_TEXELS, WORLD_CHUNK_TEXELS, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            *texture = LoadTextureFromImage(image);
+            SetTextureFilter(*texture, TEXTURE_FILTER_BILINEAR);
+            SetTextureWrap(*texture, TEXTURE_WRAP_CLAMP);
+        } else {
+            UpdateTexture(*texture, pixels);
+        }
+    }
+}
+
+int world_draw(const WorldRenderer *renderer, SimRect visible){
+    if (visible.width <= 0 || visible.height <= 0) return 0;
+    const World *world = renderer->world;
+    int start_x = (int)floorf(visible.x / WORLD_CHUNK_SIZE);
+    int start_y = (int)floorf(visible.y / WORLD_CHUNK_SIZE);
+    int end_x = (int)floorf((visible.x + visible.width) / WORLD_CHUNK_SIZE);
+    int end_y = (int)floorf((visible.y + visible.height) / WORLD_CHUNK_SIZE);
+    int missing = 0;
+
+    /**
+     * TINT MAPS
+     * ---------
+     * Texel centres sit exactly on a grid whose outer rows lie on the chunk border
+     * (see generate_chunk), so the source rectangle runs from the first texel's
+     * centre to the last one's. With bilinear filtering the colour along a shared
+     * edge is then the same on both sides and the chunk grid never shows.
+     */
+    Rectangle source = {0.5f, 0.5f, WORLD_CHUNK_TEXELS - 1, WORLD_CHUNK_TEXELS - 1};
+    BeginBlendMode(BLEND_MULTIPLIED);
+    for (int cy = start_y; cy <= end_y; cy++) {
+        for (int cx = start_x; cx <= end_x; cx++) {
+            const Chunk *chunk = world_chunk(world, cx, cy);
+            if (!chunk || chunk->state != CHUNK_READY) {
+                missing++;
+                continue;
+            }
+            Rectangle dest = {(float)cx * WORLD_CHUNK_SIZE, (float)cy * WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE};
+            DrawTexturePro(renderer->textures[chunk - world->slots], source, dest, (Vector2){0, 0}, 0, WHITE);
+            render_stats_count(1);
+        }
+    }
+    EndBlendMode();
+
+    for (int cy = start_y; cy <= end_y; cy++) {
+        for (int cx = start_x; cx <= end_x; cx++) {
+            const Chunk *chunk = world_chunk(world, cx, cy);
+            if (!chunk || chunk->state != CHUNK_READY) continue;
+            for (int i = 0; i < chunk->decoration_count; i++) {
+                const Decoration *decoration = &chunk->decorations[i];
+                float r = decoration->radius;
+                if (decoration->x + r < visible.x || decoration->x - r > visible.x + visible.width ||
+                    decoration->y + r < visible.y || decoration->y - r > visible.y + visible.height) continue;
+                DrawCircleV((Vector2){decoration->x, decoration->y}, r, decoration_colors[decoration->kind]);
+                render_stats_count(1);
+            }
+        }
+    }
+    return missing;
+}
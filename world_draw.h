@@ -0,0 +1,32 @@
+#ifndef WORLD_DRAW_H
+#define WORLD_DRAW_H
+
+#include <raylib.h>
+#include "world.h"
+
+// ----------------------------
+// CHUNK RENDERER
+// ----------------------------
+// Uploads generated chunks and draws them over the soil: each chunk's tint map is
+// stretched over the chunk with a multiply blend, then its decorations on top.
+// Every slot owns one small texture that is reused (UpdateTexture) when the slot
+// gets a new chunk, so streaming does no GPU allocation after warm-up.
+
+#define WORLD_UPLOADS_PER_FRAME 16   // Cap on texture updates per frame
+
+typedef struct {
+    World *world;
+    Texture2D *textures;   // One per world slot, id 0 until first used
+} WorldRenderer;
+
+int world_renderer_init(WorldRenderer *renderer, World *world);
+void world_renderer_free(WorldRenderer *renderer);
+
+// Uploads up to WORLD_UPLOADS_PER_FRAME finished chunks
+void world_renderer_upload(WorldRenderer *renderer);
+
+// Draws the chunks under `visible` inside BeginMode2D(); returns how many visible
+// chunks were not ready yet (those show the plain soil underneath)
+int world_draw(const WorldRenderer *renderer, SimRect visible);
+
+#endif